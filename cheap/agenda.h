@@ -23,16 +23,90 @@
 #ifndef _AGENDA_H_
 #define _AGENDA_H_
 
-#include <queue>
+#include <functional>
 #include <vector>
 
 #include "item.h"
 #include "options.h"
+#include "pool-alloc.h"
 #include "task.h"
 
 
-/** agenda: a priority queue adapter */
-template <typename T, typename LESS_THAN > class abstract_agenda {
+/** A 4-ary max-heap of tasks that keeps the sort key of every task next to
+ *  the task pointer.
+ *
+ * Sifting compares the keys in one contiguous array instead of following the
+ * pointers to the tasks (which are scattered over the heap) for every
+ * comparison, and the wider nodes make the heap flatter than a binary one.
+ * \a KEY_LESS orders the keys, the largest key is on top.
+ */
+template <typename T, typename KEY, typename KEY_LESS = std::less<KEY> >
+class task_heap {
+public:
+  task_heap() : _heap(), _less() {}
+
+  inline bool empty() const { return _heap.empty(); }
+  inline T *top() const { return _heap.front().task; }
+
+  inline void push(const KEY &key, T *t) {
+    _heap.push_back(entry(key, t));
+    sift_up(_heap.size() - 1);
+  }
+
+  inline void pop() {
+    _heap.front() = _heap.back();
+    _heap.pop_back();
+    if(!_heap.empty()) sift_down(0);
+  }
+
+private:
+  static const size_t D = 4;
+
+  struct entry {
+    KEY key;
+    T *task;
+    entry(const KEY &k, T *t) : key(k), task(t) {}
+  };
+
+  void sift_up(size_t i) {
+    entry e = _heap[i];
+    while(i > 0) {
+      size_t parent = (i - 1) / D;
+      if(!_less(_heap[parent].key, e.key)) break;
+      _heap[i] = _heap[parent];
+      i = parent;
+    }
+    _heap[i] = e;
+  }
+
+  void sift_down(size_t i) {
+    entry e = _heap[i];
+    size_t n = _heap.size();
+    while(true) {
+      size_t first = i * D + 1;
+      if(first >= n) break;
+      size_t last = (first + D < n) ? first + D : n;
+      size_t best = first;
+      for(size_t c = first + 1; c < last; ++c)
+        if(_less(_heap[best].key, _heap[c].key)) best = c;
+      if(!_less(e.key, _heap[best].key)) break;
+      _heap[i] = _heap[best];
+      i = best;
+    }
+    _heap[i] = e;
+  }
+
+  std::vector<entry> _heap;
+  KEY_LESS _less;
+};
+
+
+/** agenda: a priority queue adapter.
+ *  All agendas order their tasks with a task_heap on the key they compute
+ *  from \c T::priority() (and the span, for the wavefront agenda), so there
+ *  is no comparison predicate on the tasks themselves.
+ */
+template <typename T> class abstract_agenda {
 public:
 
   virtual ~abstract_agenda() {}
@@ -43,16 +117,24 @@ public:
   virtual bool empty() = 0;
   virtual void feedback (T *t, tItem *result) = 0;
 
+  /** The arena of the tasks on this agenda. The derived agendas delete the
+   *  tasks still queued in their destructors, then the arena is released as
+   *  a whole.
+   */
+  pool_allocator &pool() { return _pool; }
+
+private:
+  pool_allocator _pool;
 };
 
 
-template <typename T, typename LESS_THAN > class exhaustive_agenda : public abstract_agenda<T, LESS_THAN > {
+template <typename T> class exhaustive_agenda : public abstract_agenda<T> {
 public :
 
   exhaustive_agenda() : _A() {}
   ~exhaustive_agenda() { while(!this->empty()) delete this->pop(); }
 
-  void push(T *t) { _A.push(t); }
+  void push(T *t) { _A.push(t->priority(), t); }
   T * top()       { return _A.top(); }
   T * pop()       { T *t = top(); _A.pop(); return t; }
   bool empty()    { return _A.empty(); }
@@ -60,18 +142,66 @@ public :
 
 private:
 
-  std::priority_queue<T *, std::vector<T *>, LESS_THAN> _A;
+  task_heap<T, double> _A;
 };
 
 
 
+/*
+ * WAVEFRONT AGENDA
+ */
+
+/** An agenda that hands out tasks in order of increasing length of the span
+ *  they will produce an item for, and by priority within one span length.
+ *
+ * Since new items only ever produce tasks for spans at least as long as their
+ * own, this processes the chart in CKY-style wavefronts: all items of one
+ * span length are built (and packed) before any longer item is started. This
+ * helps ambiguity packing, because an item only meets larger items after
+ * all equivalent smaller ones have been packed into each other.
+ */
+template <typename T> class wavefront_agenda : public abstract_agenda<T> {
+public :
+
+  wavefront_agenda() : _A() {}
+  ~wavefront_agenda() { while(!this->empty()) delete this->pop(); }
+
+  void push(T *t) {
+    _A.push(wave_key(t->end() - t->start(), t->priority()), t);
+  }
+  T * top()       { return _A.top(); }
+  T * pop()       { T *t = top(); _A.pop(); return t; }
+  bool empty()    { return _A.empty(); }
+  void feedback (T *t, tItem *result) {}
+
+private:
+
+  /** The span length and priority of a task */
+  struct wave_key {
+    int length;
+    double priority;
+    wave_key(int l, double p) : length(l), priority(p) {}
+  };
+
+  /** Shorter spans first, priority order within one span length */
+  class span_less {
+  public:
+    bool operator()(const wave_key &x, const wave_key &y) const {
+      if(x.length != y.length) return x.length > y.length;
+      return x.priority < y.priority;
+    }
+  };
+
+  task_heap<T, wave_key, span_less> _A;
+};
+
 
 
 /*
  * LOCAL CAP AGENDA
  */
 
-template <typename T, typename LESS_THAN > class local_cap_agenda : public abstract_agenda<T, LESS_THAN > {
+template <typename T> class local_cap_agenda : public abstract_agenda<T> {
 /* This class provides functionality to define a per-cell cap on the number of tasks to be executed. */
 
 public :
@@ -82,7 +212,7 @@ public :
   ~local_cap_agenda();
 
   void push(T *t) {
-    _A.push(t);
+    _A.push(t->priority(), t);
   }
   T * top();
   T * pop();
@@ -91,7 +221,7 @@ public :
 
 private:
 
-  std::priority_queue<T *, std::vector<T *>, LESS_THAN> _A;
+  task_heap<T, double> _A;
   std::vector<int> _popped;
   int _max_pos;
   int _cell_size;
@@ -106,8 +236,8 @@ private:
  * (implementation here, due to use of templates)
  */
 
-template <typename T, class LESS_THAN>
-local_cap_agenda<T, LESS_THAN>::~local_cap_agenda() {
+template <typename T>
+local_cap_agenda<T>::~local_cap_agenda() {
   while (!_A.empty()) {
     T* t = _A.top();
     delete t;
@@ -115,8 +245,8 @@ local_cap_agenda<T, LESS_THAN>::~local_cap_agenda() {
   }
 }
 
-template <typename T, class LESS_THAN>
-T * local_cap_agenda<T, LESS_THAN>::top() {
+template <typename T>
+T * local_cap_agenda<T>::top() {
   T* t;
   bool found = false;
   while (!found) {
@@ -138,8 +268,8 @@ T * local_cap_agenda<T, LESS_THAN>::top() {
   return t;
 }
 
-template <typename T, class LESS_THAN>
-T * local_cap_agenda<T, LESS_THAN>::pop() {
+template <typename T>
+T * local_cap_agenda<T>::pop() {
   T *t = top();
   if (t != NULL) {
     _A.pop();
@@ -147,8 +277,8 @@ T * local_cap_agenda<T, LESS_THAN>::pop() {
   return t;
 }
 
-template <typename T, class LESS_THAN>
-void local_cap_agenda<T, LESS_THAN>::feedback (T *t, tItem *result) {
+template <typename T>
+void local_cap_agenda<T>::feedback (T *t, tItem *result) {
   if (t->phrasal()) {
     if (get_opt_int("opt_chart_pruning_strategy") == 0) {
       ++_popped[t->start()*(_max_pos+1) + t->end()];
@@ -53,6 +53,13 @@ int results(int session_id) {
   return SessionManager::getManager().results(session_id);
 }
 
+/** Return the number of results unpacked so far; \c more tells whether
+ *  get_result_item() may find further ones.
+ */
+int results(int session_id, bool &more) {
+  return SessionManager::getManager().results(session_id, more);
+}
+
 class tItem *get_result_item(int session_id, size_t result_no) {
   return SessionManager::getManager().get_result_item(session_id, result_no);
 }
@@ -24,6 +24,8 @@
 #include "item-printer.h"
 #include "logging.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace HASH_SPACE;
 
@@ -33,17 +35,19 @@ chart::chart(int len, auto_ptr<item_owner> owner)
     : _Chart(), _trees(), _readings(), _pedges(0),
       _Cp_start(len + 1), _Cp_end(len + 1),
       _Ca_start(len + 1), _Ca_end(len + 1),
-      _Cp_span(len + 1),
+      _Cp_span(len + 1), _Cp_buckets(len + 1), _unpacker(NULL),
       _item_owner(owner)
 {
     for(int i = 0; i <= len; ++i)
     {
         _Cp_span[i].resize(len + 1 - i);
+        _Cp_buckets[i].resize(len + 1 - i);
     }
 }
 
 chart::~chart()
 {
+    delete _unpacker;
 }
 
 void chart::reset(int len)
@@ -59,6 +63,10 @@ void chart::reset(int len)
         _Cp_span[i].clear();
         _Cp_span[i].resize(len + 1 - i);
     }
+    _Cp_packing.clear();
+    _Cp_buckets.clear(); _Cp_buckets.resize(len + 1);
+    for (int i = 0; i <= len; ++i)
+        _Cp_buckets[i].resize(len + 1 - i);
 }
 
 void chart::add(tItem *it)
@@ -94,6 +102,12 @@ private:
   hash_set<tItem *> _set;
 };
 
+/** Remove \a it from the chart index \a items */
+static inline void erase_item(chart_item_vector &items, tItem *it)
+{
+    items.erase(std::remove(items.begin(), items.end(), it), items.end());
+}
+
 /** Remove the items in the set from the chart */
 void chart::remove(hash_set<tItem *> &to_delete)
 {
@@ -108,21 +122,61 @@ void chart::remove(hash_set<tItem *> &to_delete)
       tItem *it = *hit;
       if(it->passive())
         {
-          _Cp_start[it->start()].remove(it);
-          _Cp_end[it->end()].remove(it);
-          _Cp_span[it->start()][it->end()-it->start()].remove(it);
+          erase_item(_Cp_start[it->start()], it);
+          erase_item(_Cp_end[it->end()], it);
+          erase_item(_Cp_span[it->start()][it->end()-it->start()], it);
+          if(! _Cp_packing.empty()) {
+            hash_map<packing_key, item_list, packing_key_hash>::iterator pit
+              = _Cp_packing.find(packing_key(it));
+            if(pit != _Cp_packing.end()) pit->second.remove(it);
+            packing_bucket_vector &buckets
+              = _Cp_buckets[it->start()][it->end()-it->start()];
+            for(packing_bucket_vector::iterator bit = buckets.begin();
+                bit != buckets.end(); ++bit)
+              erase_item(bit->items, it);
+          }
           _pedges--;
         }
       else
         {
           if(it->left_extending())
-            _Ca_start[it->start()].remove(it);
+            erase_item(_Ca_start[it->start()], it);
           else
-            _Ca_end[it->end()].remove(it);
+            erase_item(_Ca_end[it->end()], it);
         }
     }
 }
 
+chart::packing_key::packing_key(tItem *it)
+  : start(it->start()), end(it->end()), fingerprint(it->fingerprint()) {
+}
+
+void chart::add_packing_index(tItem *it)
+{
+    _Cp_packing[packing_key(it)].push_back(it);
+
+    // there are only few distinct root types and rules per span
+    type_t type = it->get_fs().type();
+    grammar_rule *rule = it->rule();
+    packing_bucket_vector &buckets
+      = _Cp_buckets[it->start()][it->end()-it->start()];
+    packing_bucket_vector::iterator bit = buckets.begin();
+    while(bit != buckets.end() && (bit->type != type || bit->rule != rule))
+      ++bit;
+    if(bit == buckets.end())
+      bit = buckets.insert(buckets.end(), packing_bucket(type, rule));
+    bit->items.push_back(it);
+}
+
+const item_list *chart::packing_candidates(tItem *it)
+{
+    if(_Cp_packing.empty()) return NULL;
+    hash_map<packing_key, item_list, packing_key_hash>::const_iterator pit
+      = _Cp_packing.find(packing_key(it));
+    if(pit == _Cp_packing.end() || pit->second.empty()) return NULL;
+    return &pit->second;
+}
+
 void chart::print(tAbstractItemPrinter *pr, item_predicate toprint) const {
   for(chart_iter_filtered pos(this, toprint); pos.valid(); ++pos) {
     pr->print(pos.current());
@@ -219,7 +273,7 @@ chart::connected(item_predicate valid) {
   current.push(0);
   while(! reached[rightmost()] && ! current.empty()) {
     pos = current.front(); current.pop();
-    for(item_iter it = _Cp_start[pos].begin()
+    for(chart_item_vector::iterator it = _Cp_start[pos].begin()
           ; it != _Cp_start[pos].end(); ++it) {
       if (! reached[(*it)->end()] && valid(*it)) {
         reached[(*it)->end()] = true;
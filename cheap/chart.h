@@ -32,6 +32,10 @@
 #include <list>
 #include <memory>
 #include <queue>
+#include <vector>
+
+/** The items of one chart index, in the order they were added */
+typedef std::vector<tItem *> chart_item_vector;
 
 /** Chart data structure for parsing, aka dynamic programming */
 class chart {
@@ -60,6 +64,37 @@ public:
   /** Remove the item in the set from the chart */
   void remove(HASH_SPACE::hash_set<tItem *> &to_delete);
 
+  /** Enter the passive item \a it (which is already in the chart) into the
+   *  packing index, see packing_candidates() and packing_buckets().
+   */
+  void add_packing_index(tItem *it);
+
+  /** Return the indexed passive items with the same span as \a it whose
+   *  feature structure has the same fingerprint, or \c NULL if there are
+   *  none. These are the candidates for equivalence packing of \a it.
+   */
+  const item_list *packing_candidates(tItem *it);
+
+  /** The indexed passive items of one span whose feature structures have the
+   *  same root type and which were built by the same rule (\c NULL for
+   *  lexical items). The subsumption filter and the root type test of
+   *  packing give the same answer for all items of a bucket.
+   */
+  struct packing_bucket {
+    type_t type;
+    grammar_rule *rule;
+    chart_item_vector items;
+    packing_bucket(type_t t, grammar_rule *r) : type(t), rule(r), items() {}
+  };
+  typedef std::vector<packing_bucket> packing_bucket_vector;
+
+  /** Return the buckets of the indexed passive items from \a start to
+   *  \a end, in the order the buckets were created.
+   */
+  const packing_bucket_vector &packing_buckets(int start, int end) const {
+    return _Cp_buckets[start][end - start];
+  }
+
   /** Print chart items using \a aip.
    *  Enable/disable printing of passive, active and blocked items.
    */
@@ -89,6 +124,15 @@ public:
   /** Return the readings found during parsing */
   std::vector<tItem *> &readings() { return _readings; }
 
+  /** Return the unpacker of the readings that have not been unpacked yet,
+   *  or \c NULL if all readings are in readings().
+   */
+  tSelectiveUnpacker *unpacker() { return _unpacker; }
+  /** Keep \a u to unpack further readings on demand, the chart takes
+   *  ownership of it.
+   */
+  void unpacker(tSelectiveUnpacker *u) { delete _unpacker; _unpacker = u; }
+
   /** Compute a shortest path through the chart based on the \a weight_fn
    *  function that returns a weight for every chart item.
    *
@@ -126,9 +170,35 @@ private:
 
   int _pedges;
 
-  std::vector< item_list > _Cp_start, _Cp_end;
-  std::vector< item_list > _Ca_start, _Ca_end;
-  std::vector< std::vector < item_list > > _Cp_span;
+  // The chart indices are vectors rather than lists: they are only appended
+  // to while parsing, and the adjacency iterators then walk contiguous memory
+  std::vector< chart_item_vector > _Cp_start, _Cp_end;
+  std::vector< chart_item_vector > _Ca_start, _Ca_end;
+  std::vector< std::vector < chart_item_vector > > _Cp_span;
+
+  /** Key of the packing index: span and feature structure fingerprint */
+  struct packing_key {
+    int start, end;
+    unsigned long long fingerprint;
+    packing_key(tItem *it);
+    bool operator==(const packing_key &k) const {
+      return fingerprint == k.fingerprint && start == k.start && end == k.end;
+    }
+  };
+  struct packing_key_hash {
+    inline size_t operator()(const packing_key &k) const {
+      return (size_t) (k.fingerprint ^ (k.fingerprint >> 32))
+        ^ (size_t) (k.start * 1021 + k.end);
+    }
+  };
+  /** Passive items indexed by packing_key, see add_packing_index() */
+  HASH_SPACE::hash_map<packing_key, item_list, packing_key_hash> _Cp_packing;
+  /** Passive items indexed by span (like _Cp_span), root type and rule, see
+   *  packing_buckets()
+   */
+  std::vector< std::vector< packing_bucket_vector > > _Cp_buckets;
+
+  tSelectiveUnpacker *_unpacker;
 
   std::auto_ptr<item_owner> _item_owner;
 
@@ -222,16 +292,14 @@ public:
    *  ending at \a i2.
    */
   inline chart_iter_span_passive(chart *C, int i1, int i2) :
-    _LI(C->_Cp_span[i1][i2-i1]) {
-    _curr = _LI.begin();
+    _LI(C->_Cp_span[i1][i2-i1]), _curr(0) {
   }
 
   /** Create an iterator for all passive items in \a C starting at \a i1 and
    *  ending at \a i2.
    */
   inline chart_iter_span_passive(chart &C, int i1, int i2) :
-    _LI(C._Cp_span[i1][i2-i1]) {
-    _curr = _LI.begin();
+    _LI(C._Cp_span[i1][i2-i1]), _curr(0) {
   }
 
   /** Increase iterator */
@@ -242,20 +310,20 @@ public:
 
   /** Is the iterator still valid? */
   inline bool valid() const {
-    return _curr != _LI.end();
+    return _curr < _LI.size();
   }
 
   /** If valid(), return the current item, \c NULL otherwise. */
   inline tItem *current() {
     if(valid())
-      return *_curr;
+      return _LI[_curr];
     else
       return 0;
   }
 
 private:
-  item_list &_LI;
-  item_iter _curr;
+  const chart_item_vector &_LI;
+  chart_item_vector::size_type _curr;
 };
 
 
@@ -265,8 +333,8 @@ private:
 class chart_iter_topo {
 private:
   inline void next() {
-    while ((_curr == _LI[_currindex].end()) && ++_currindex && valid()) {
-      _curr = _LI[_currindex].begin();
+    while ((_curr == _LI[_currindex].size()) && ++_currindex && valid()) {
+      _curr = 0;
     }
   }
 
@@ -274,14 +342,14 @@ public:
   /** Create a new iterator for \a C */
   inline chart_iter_topo(chart *C) : _max(C->rightmost()), _LI(C->_Cp_start) {
     _currindex = 0;
-    _curr = _LI[_currindex].begin();
+    _curr = 0;
     next();
   }
 
   /** Create a new iterator for \a C */
   inline chart_iter_topo(chart &C) : _max(C.rightmost()), _LI(C._Cp_start) {
     _currindex = 0;
-    _curr = _LI[_currindex].begin();
+    _curr = 0;
     next();
   }
 
@@ -300,15 +368,15 @@ public:
 
   /** If valid(), return the current item, \c NULL otherwise. */
   inline tItem *current() {
-    return (valid() ? *_curr : 0);
+    return (valid() ? _LI[_currindex][_curr] : 0);
   }
 
 private:
   friend class chart;
 
   int _max, _currindex;
-  std::vector< std::list< class tItem * > > &_LI;
-  item_iter _curr;
+  const std::vector< chart_item_vector > &_LI;
+  chart_item_vector::size_type _curr;
 };
 
 /** Return all passive items adjacent to a given active item
@@ -323,8 +391,8 @@ public:
   inline
   chart_iter_adj_passive(chart *C, tItem *active)
     : _LI(active->left_extending() ?
-          C->_Cp_end[active->start()] : C->_Cp_start[active->end()]) {
-    _curr = _LI.begin();
+          C->_Cp_end[active->start()] : C->_Cp_start[active->end()]),
+      _curr(0) {
   }
 
   /** Increase iterator */
@@ -335,17 +403,17 @@ public:
 
   /** Is the iterator still valid? */
   inline bool valid() const {
-    return _curr != _LI.end();
+    return _curr < _LI.size();
   }
 
   /** If valid(), return the current item, \c NULL otherwise. */
   inline tItem *current() {
-    return (valid() ? *_curr : 0);
+    return (valid() ? _LI[_curr] : 0);
   }
 
 private:
-  item_list &_LI;
-  item_iter _curr;
+  const chart_item_vector &_LI;
+  chart_item_vector::size_type _curr;
 };
 
 /** Return all active items adjacent to a given passive item
@@ -353,11 +421,6 @@ private:
  * `excursion' works.
  */
 class chart_iter_adj_active {
-  inline void overflow() {
-    _at_start = false;
-    _curr = _LI_end.begin();
-  }
-
 public:
   /** Create new iterator for chart \a C that returns the active items
    *  adjacent to \a passive.
@@ -365,42 +428,33 @@ public:
   inline chart_iter_adj_active(chart *C, tItem *passive)
     : _LI_start(C->_Ca_start[passive->end()]),
       _LI_end(C->_Ca_end[passive->start()]),
-      _at_start(true) {
-    _curr = _LI_start.begin();
-    if(_curr == _LI_start.end()) overflow();
+      _curr(0) {
   }
 
   /** Increase iterator */
   inline chart_iter_adj_active &operator++() {
     ++_curr;
-    if(_at_start && _curr == _LI_start.end())
-      overflow();
-
     return *this;
   }
 
   /** Is the iterator still valid? */
-  inline bool valid() {
-    if (_at_start && _curr == _LI_start.end()) {
-      overflow();
-    }
-    if (_at_start) {
-      return true;
-    }
-    return _curr != _LI_end.end();
+  inline bool valid() const {
+    return _curr < _LI_start.size() + _LI_end.size();
   }
 
   /** If valid(), return the current item, \c NULL otherwise. */
   inline tItem *current() {
-    return (valid() ? *_curr : 0);
+    if(! valid()) return 0;
+    // first the items starting at the end of the passive item, then the
+    // ones ending at its start
+    return (_curr < _LI_start.size()
+            ? _LI_start[_curr] : _LI_end[_curr - _LI_start.size()]);
   }
 
 private:
-  item_list &_LI_start, &_LI_end;
+  const chart_item_vector &_LI_start, &_LI_end;
 
-  bool _at_start;
-
-  item_iter _curr;
+  chart_item_vector::size_type _curr;
 };
 /** Return all passive items ending at a specific point.
  * \attention iterators must return items in order of `stamp', so the
@@ -411,15 +465,13 @@ public:
   /** Create an iterator for all passive items in \a C ending at \a i.
    */
   inline chart_iter_end_passive(chart *C, int i) :
-    _LI(C->_Cp_end[i]) {
-    _curr = _LI.begin();
+    _LI(C->_Cp_end[i]), _curr(0) {
   }
 
   /** Create an iterator for all passive items in \a C ending at \a i.
    */
   inline chart_iter_end_passive(chart &C, int i) :
-    _LI(C._Cp_end[i]) {
-    _curr = _LI.begin();
+    _LI(C._Cp_end[i]), _curr(0) {
   }
 
   /** Increase iterator */
@@ -430,20 +482,20 @@ public:
 
   /** Is the iterator still valid? */
   inline bool valid() const {
-    return _curr != _LI.end();
+    return _curr < _LI.size();
   }
 
   /** If valid(), return the current item, \c NULL otherwise. */
   inline tItem *current() {
     if(valid())
-      return *_curr;
+      return _LI[_curr];
     else
       return 0;
   }
 
 private:
-  item_list &_LI;
-  item_iter _curr;
+  const chart_item_vector &_LI;
+  chart_item_vector::size_type _curr;
 };
 
 
@@ -465,7 +517,7 @@ void chart::shortest_path(std::list <tItem *> &result, weight_fn_t weight_fn
   weight_t *distance = new weight_t[size + 1] ;
   weight_t new_dist ;
 
-  item_iter curr ;
+  chart_item_vector::iterator curr ;
   tItem *passive ;
 
   // compute the minimal distance and minimal distance predecessor nodes for
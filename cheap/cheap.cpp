@@ -835,6 +835,22 @@ static void init_main_options() {
   managed_opt("opt_server",
     "go into server mode, bind to port `n' (default: 4711)",
     0);
+  managed_opt("opt_server_workers",
+    "number of parse worker processes of the XML-RPC server "
+    "(0: parse in the server process)", 0);
+  managed_opt("opt_server_queue",
+    "maximal number of XML-RPC requests waiting for a parse worker", 16);
+  managed_opt("opt_server_prefork",
+    "number of pre-forked children of the socket server "
+    "(0: one child per connection)", 0);
+  managed_opt("opt_server_recycle",
+    "replace a pre-forked child after it has processed `n' items "
+    "(0: never)", 0);
+  managed_opt("opt_server_recycle_mem",
+    "replace a pre-forked child after it has grown by `n' MB (0: never)", 0);
+  managed_opt("opt_server_warmup",
+    "file with sentences to parse before forking the socket server's "
+    "children, to populate the shared caches", string());
   managed_opt("opt_pg",
     "print grammar in ASCII form, one of (s)ymbols (the default), (g)lbs "
     "(t)ype fs's or (a)ll", '\0');
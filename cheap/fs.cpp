@@ -29,8 +29,12 @@
 #include "configs.h"
 #include "logging.h"
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 using namespace std;
 
@@ -42,6 +46,8 @@ using namespace std;
 // global variables for quick check
 qc_node *fs::_qc_paths_unif = NULL, *fs::_qc_paths_subs = NULL;
 int fs::_qc_len_unif = 0, fs::_qc_len_subs = 0;
+int *fs::_qc_order_unif = NULL;
+unsigned int *fs::_qc_fails_unif = NULL;
 
 /** compute quickcheck paths (unification) */
 bool opt_compute_qc_unif;
@@ -63,6 +69,13 @@ static bool fs_init() {
               "use only top n quickcheck paths (unification)", (int) -1);
   managed_opt("opt_nqc_subs",
               "use only top n quickcheck paths (subsumption)", (int) -1);
+  managed_opt("opt_qc_adapt",
+              "count which unification quickcheck paths fail and test the "
+              "most selective ones first", false);
+  managed_opt("opt_qc_order",
+              "file to read the unification quickcheck order from (and to "
+              "write the adapted order to, if opt_qc_adapt is set)",
+              string());
 
   opt_compute_qc_unif = false;
   reference_opt("opt_compute_qc_unif",
@@ -680,6 +693,48 @@ qc_vec fs::get_qc_vector(qc_node *qc_paths, int qc_len) const {
   return vector;
 }
 
+int
+fs::qc_filter_unif(const qc_vec &a, const qc_vec *bs, int n, char *ok) {
+  int alive = 0;
+  for(int j = 0; j < n; ++j)
+    if(ok[j]) ++alive;
+
+  for(int k = 0; k < _qc_len_unif && alive > 0; ++k) {
+    int i = _qc_order_unif[k];
+    type_t t = a[i];
+    // top is compatible with everything
+    if(t == BI_TOP) continue;
+    for(int j = 0; j < n; ++j) {
+      if(! ok[j]) continue;
+      type_t u = bs[j][i];
+      if(u != t && u != BI_TOP && glb(t, u) == T_BOTTOM) {
+#ifdef PETDEBUG
+        LOG(logAppl, DEBUG, "quickcheck fails for path " << i
+            << " with `" << print_name(t)
+            << "' vs. `" << print_name(u) << "'");
+#endif
+        ok[j] = 0;
+        --alive;
+        if(_qc_fails_unif != NULL) ++_qc_fails_unif[i];
+      }
+    }
+  }
+
+  return alive;
+}
+
+bool
+fs::qc_record_unif(const qc_vec &a, const qc_vec &b, unsigned int *rejects) {
+  bool compatible = true;
+  for(int i = 0; i < _qc_len_unif; ++i) {
+    if(glb(a[i], b[i]) == T_BOTTOM) {
+      ++rejects[i];
+      compatible = false;
+    }
+  }
+  return compatible;
+}
+
 /** Initialize the static variables for quick check appropriately */
 void
 fs::init_qc_unif(dumper *f, bool subs_too) {
@@ -694,6 +749,143 @@ fs::init_qc_unif(dumper *f, bool subs_too) {
   }
   if(nqc_unif > 0 && nqc_unif < _qc_len_unif)
     _qc_len_unif = nqc_unif;
+
+  delete[] _qc_order_unif;
+  _qc_order_unif = new int[_qc_len_unif];
+  for(int i = 0; i < _qc_len_unif; ++i)
+    _qc_order_unif[i] = i;
+  delete[] _qc_fails_unif;
+  _qc_fails_unif = NULL;
+  if(get_opt_bool("opt_qc_adapt")) {
+    _qc_fails_unif = new unsigned int[_qc_len_unif];
+    memset(_qc_fails_unif, 0, _qc_len_unif * sizeof(unsigned int));
+  }
+
+  const string &orderfile = get_opt_string("opt_qc_order");
+  if(! orderfile.empty())
+    qc_load_order_unif(orderfile);
+}
+
+/** The number of parses between two saves of the adapted quick check order */
+#define QC_ORDER_SAVE_INTERVAL 100
+
+/** Once the failure counts of all slots add up to more than this, they are
+ *  halved, so that the counts reflect roughly the last this many failures
+ *  and the order follows a change in the input.
+ */
+#define QC_ORDER_DECAY_WINDOW (1U << 16)
+
+/** Read the unification quick check order from \a filename.
+ *
+ * The file contains one line per quick check slot, in test order, with the
+ * slot number and the number of failures recorded for it. Lines starting with
+ * `;' are comments. A missing file is not an error (it is created when
+ * adapting); a file that does not match the current quick check vectors is
+ * ignored with a warning.
+ */
+void
+fs::qc_load_order_unif(const string &filename) {
+  ifstream in(filename.c_str());
+  if(! in) return;
+
+  vector<int> order;
+  vector<unsigned int> fails;
+  vector<bool> seen(_qc_len_unif, false);
+  string line;
+  while(getline(in, line)) {
+    if(line.empty() || line[0] == ';') continue;
+    istringstream is(line);
+    int slot;
+    unsigned int count = 0;
+    if(! (is >> slot) || slot < 0 || slot >= _qc_len_unif || seen[slot]) {
+      LOG(logAppl, WARN, "ignoring quickcheck order in `" << filename
+          << "': invalid slot in line `" << line << "'");
+      return;
+    }
+    is >> count;
+    seen[slot] = true;
+    order.push_back(slot);
+    fails.push_back(count);
+  }
+  if((int) order.size() != _qc_len_unif) {
+    LOG(logAppl, WARN, "ignoring quickcheck order in `" << filename
+        << "': " << order.size() << " slots instead of " << _qc_len_unif);
+    return;
+  }
+
+  for(int k = 0; k < _qc_len_unif; ++k) {
+    _qc_order_unif[k] = order[k];
+    if(_qc_fails_unif != NULL)
+      _qc_fails_unif[order[k]] = fails[k];
+  }
+  LOG(logAppl, INFO, "read quickcheck order from `" << filename << "'");
+}
+
+/** Write the unification quick check order to \a filename, see
+ *  qc_load_order_unif() for the format.
+ */
+void
+fs::qc_save_order_unif(const string &filename) {
+  ofstream out(filename.c_str());
+  if(! out) {
+    LOG(logAppl, WARN, "could not write quickcheck order to `"
+        << filename << "'");
+    return;
+  }
+  out << "; unification quickcheck order: slot, failures" << endl;
+  for(int k = 0; k < _qc_len_unif; ++k) {
+    int i = _qc_order_unif[k];
+    out << i << " " << (_qc_fails_unif != NULL ? _qc_fails_unif[i] : 0)
+        << endl;
+  }
+}
+
+namespace {
+  /** Order quick check slots by decreasing failure count */
+  struct qc_more_failures {
+    const unsigned int *_fails;
+    qc_more_failures(const unsigned int *fails) : _fails(fails) {}
+    bool operator()(int a, int b) const { return _fails[a] > _fails[b]; }
+  };
+}
+
+void
+fs::qc_adapt_order_unif() {
+  if(_qc_fails_unif == NULL) return;
+
+  // age the counts so that the order can follow a change in the input; an
+  // order loaded from a file may start out far above the window
+  unsigned long long total = 0;
+  for(int i = 0; i < _qc_len_unif; ++i)
+    total += _qc_fails_unif[i];
+  while(total > QC_ORDER_DECAY_WINDOW) {
+    total = 0;
+    for(int i = 0; i < _qc_len_unif; ++i) {
+      _qc_fails_unif[i] /= 2;
+      total += _qc_fails_unif[i];
+    }
+  }
+
+  // a stable sort keeps the original (static) order among equally good slots
+  stable_sort(_qc_order_unif, _qc_order_unif + _qc_len_unif,
+              qc_more_failures(_qc_fails_unif));
+
+  static int parses = 0;
+  const string &orderfile = get_opt_string("opt_qc_order");
+  if(++parses % QC_ORDER_SAVE_INTERVAL == 0 && ! orderfile.empty())
+    qc_save_order_unif(orderfile);
+}
+
+void
+fs::free_qc() {
+  const string &orderfile = get_opt_string("opt_qc_order");
+  if(_qc_fails_unif != NULL && ! orderfile.empty())
+    qc_save_order_unif(orderfile);
+
+  delete[] _qc_order_unif;
+  _qc_order_unif = NULL;
+  delete[] _qc_fails_unif;
+  _qc_fails_unif = NULL;
 }
 
 void
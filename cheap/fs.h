@@ -30,6 +30,8 @@
 #include "types.h"
 #include "dag.h"
 
+#include <vector>
+
 /** Features structure modification list: a list of pairs (path, type).
  * In these modlists, the path is represented by a string where the feature
  * names are separated by dots ('.')
@@ -47,6 +49,11 @@ class fs
   static qc_node *_qc_paths_unif, *_qc_paths_subs;
   /** Number of the unification/subsumption quick check paths to consider */
   static int _qc_len_unif, _qc_len_subs;
+  /** The order in which the unification quick check slots are tested */
+  static int *_qc_order_unif;
+  /** For every unification quick check slot, how often it was the first one
+      to reject a pair. Only allocated if the order is adapted at run time. */
+  static unsigned int *_qc_fails_unif;
   /*@}*/
 
  public:
@@ -216,6 +223,16 @@ class fs
   /* initialize the qc structure for subsumption from the dumper stream \a f. */
   static void init_qc_subs(class dumper *f);
 
+  /** Sort the unification quick check slots such that the slots that
+   *  rejected most pairs so far are tested first.
+   *
+   * Only has an effect if \c opt_qc_adapt is set. The new order is written
+   * to \c opt_qc_order (if given) every now and then.
+   */
+  static void qc_adapt_order_unif();
+  /** Save the adapted quick check order (if any) and free the order tables */
+  static void free_qc();
+
   static int get_unif_qc_length() { return _qc_len_unif; }
   static int get_subs_qc_length() { return _qc_len_subs; }
 
@@ -239,8 +256,10 @@ class fs
    *  respect to unification. \a qc_len is the length of the vectors.
    */
   inline static bool qc_compatible_unif(const qc_vec &a, const qc_vec &b) {
-    for(int i = 0; i < _qc_len_unif; ++i) {
+    for(int k = 0; k < _qc_len_unif; ++k) {
+      int i = _qc_order_unif[k];
       if(glb(a[i], b[i]) == T_BOTTOM) {
+        if(_qc_fails_unif != NULL) ++_qc_fails_unif[i];
 #ifdef PETDEBUG
         LOG(logAppl, DEBUG, "quickcheck fails for path " << i
             << " with `" << print_name(a[i])
@@ -252,10 +271,46 @@ class fs
     return true;
   }
 
+  /** \brief Check quick check vectors \a a and \a b for compatibility with
+   *  respect to unification, testing only the slots in \a slots.
+   */
+  inline static bool qc_compatible_unif(const qc_vec &a, const qc_vec &b,
+                                        const std::vector<int> &slots) {
+    for(std::vector<int>::const_iterator it = slots.begin();
+        it != slots.end(); ++it) {
+      if(glb(a[*it], b[*it]) == T_BOTTOM)
+        return false;
+    }
+    return true;
+  }
+
+  /** \brief Check quick check vectors \a a and \a b for compatibility with
+   *  respect to unification on all slots, and count every slot that rejects
+   *  the pair in \a rejects.
+   */
+  static bool qc_record_unif(const qc_vec &a, const qc_vec &b,
+                             unsigned int *rejects);
+
+  /** \brief Batched version of qc_compatible_unif(): check \a a against the
+   *  \a n vectors in \a bs at once.
+   *
+   * The vectors are tested path by path rather than vector by vector, so the
+   * first (most discriminating) paths are checked for all candidates before
+   * the later ones, and candidates drop out as soon as one path fails.
+   * Candidates with \a ok[i] == 0 on entry are skipped, on return \a ok[i] is
+   * 0 for all candidates that failed.
+   * \return the number of candidates that passed
+   */
+  static int qc_filter_unif(const qc_vec &a, const qc_vec *bs, int n,
+                            char *ok);
+
   /** Check to quick check vectors \a a and \a b for compatibility with respect
    *  to subsumption in both directions. \a qc_len is the length of the
    *  vectors. If \a a subsumes \a b, \a forward is \c true on return,
    *  analogously for \a backward.
+   *  A slot is 0 where the path is missing or leads through an unfilled node.
+   *  subsumes() fills in such nodes and ignores arcs that exist on one side
+   *  only, so slots where either vector is 0 are not compared.
    *  \attention \a forward and \a backward must be \c true when calling this
    *  function.
    */
@@ -264,7 +319,7 @@ class fs
                      bool &forward, bool &backward){
     bool st_a_b, st_b_a;
     for(int i = 0; i < _qc_len_subs; ++i) {
-      if(a[i] != b[i]) {
+      if(a[i] != b[i] && a[i] != 0 && b[i] != 0) {
         subtype_bidir(a[i], b[i], st_a_b, st_b_a);
         if(st_a_b == false) { backward = false; if (forward == false) return; }
         if(st_b_a == false) { forward = false; if (backward == false) return; }
@@ -274,6 +329,9 @@ class fs
 
  private:
 
+  static void qc_load_order_unif(const std::string &filename);
+  static void qc_save_order_unif(const std::string &filename);
+
   dag_node *_dag;
   int _temp;
 
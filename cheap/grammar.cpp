@@ -44,7 +44,9 @@
 
 #include "item-printer.h"
 #include "dagprinter.h"
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 
 #include "ut_from_pet.h"
 
@@ -73,6 +75,16 @@ static int init() {
   managed_opt("opt_lpthreshold",
     "probability threshold for discarding lexical items",
     -1.0);
+  managed_opt("opt_qc_rule_slots",
+              "file with rule specific unification quickcheck slots",
+              std::string(""));
+  managed_opt("opt_compile_sm",
+              "write the parse selection model in binary form to this file",
+              std::string(""));
+  managed_opt("opt_compute_qc_rule_slots",
+              "record which unification quickcheck slots reject pairs for "
+              "every rule argument, and write them to this file",
+              std::string(""));
 
   return true;
 }
@@ -481,6 +493,9 @@ tGrammar::tGrammar(const char * filename)
     toc.goto_section(SEC_HIERARCHY);
     undump_hierarchy(&dmp);
 
+    if(toc.goto_section(SEC_GLBTABLE))
+        undump_glbtable(&dmp);
+
     toc.goto_section(SEC_FEATTABS);
     undump_tables(&dmp);
 
@@ -488,6 +503,8 @@ tGrammar::tGrammar(const char * filename)
     if(toc.goto_section(SEC_SUPERTYPES))
         undumpSupertypes(&dmp);
 
+    initialize_subtype_index();
+
     // call unifier specific initialization
     dag_initialize();
 
@@ -600,9 +617,20 @@ tGrammar::tGrammar(const char * filename)
     for(ruleiter ri = _rules.begin(); ri != _rules.end(); ++ri)
       (*ri)->init_qc_vector_unif();
 
+    if(fs::get_unif_qc_length() > 0) {
+      if(! get_opt_string("opt_compute_qc_rule_slots").empty()) {
+        for(ruleiter ri = _rules.begin(); ri != _rules.end(); ++ri)
+          (*ri)->_qc_rejects_unif.assign((*ri)->arity(),
+            vector<unsigned int>(fs::get_unif_qc_length(), 0));
+      }
+      else if(! get_opt_string("opt_qc_rule_slots").empty())
+        read_qc_rule_slots(get_opt_string("opt_qc_rule_slots"));
+    }
+
     // _filter.valid() will be false if not initialized
     if(get_opt_bool("opt_filter")) {
-      initialize_filter();
+      if(!(toc.goto_section(SEC_RULEFILTER) && undump_filter(&dmp)))
+        initialize_filter();
     }
 
     //
@@ -623,10 +651,19 @@ tGrammar::tGrammar(const char * filename)
           // _fix_me_
           // Once we have more than just MEMs we will need to add a dispatch
           // facility here, or have a factory build the models.
-          try { _sm = new tMEM(this, sm_file, filename); }
+          try {
+            tMEM *mem = new tMEM(this, sm_file, filename);
+            _sm = mem;
+            const std::string opt_compile_sm
+              = get_opt_string("opt_compile_sm");
+            if(! opt_compile_sm.empty()) {
+              mem->writeBinary(opt_compile_sm);
+              LOG(logGrammar, INFO, "wrote binary parse selection model to `"
+                  << opt_compile_sm << "'");
+            }
+          }
           catch(tError &e) {
             LOG(logGrammar, ERROR, e.getMessage());
-            _sm = 0;
           }
         }
       } // if
@@ -867,27 +904,35 @@ tGrammar::initialize_filter() {
   _filter.resize(nrules);
   _subsumption_filter.resize(nrules);
 
+  // The restricted copies for the subsumption filter only depend on one of
+  // the rules, so they are made once per rule rather than once per pair.
+  list_int_restrictor restr(Grammar->deleted_daughters());
+  vector<fs> restricted_mothers;
+  for(ruleiter mothers = _rules.begin(); mothers != _rules.end(); ++mothers)
+    restricted_mothers.push_back(
+      packing_partial_copy((*mothers)->instantiate(), restr, false));
+
   for(ruleiter daughters = _rules.begin(); daughters != _rules.end();
       ++daughters) {
     fs_alloc_state S1;
     grammar_rule *daughter = *daughters;
     fs daughter_fs = copy(daughter->instantiate());
+    fs restricted_daughter = packing_partial_copy(daughter_fs, restr, false);
 
+    vector<fs>::iterator restricted_mother = restricted_mothers.begin();
     for(ruleiter mothers = _rules.begin(); mothers != _rules.end();
-        ++mothers) {
+        ++mothers, ++restricted_mother) {
       grammar_rule *mother = *mothers;
 
       for(int arg = 1; arg <= mother->arity(); ++arg) {
         fs_alloc_state S2;
         fs mother_fs = mother->instantiate();
-        list_int_restrictor restr(Grammar->deleted_daughters());
 
         if(arg == 1) {
           bool forward = true, backward = false;
-          fs a = packing_partial_copy(daughter_fs, restr, false);
-          fs b = packing_partial_copy(mother_fs, restr, false);
 
-          subsumes(a, b, forward, backward);
+          subsumes(restricted_daughter, *restricted_mother,
+                   forward, backward);
 
           if(forward)
             _subsumption_filter.set(mother, daughter);
@@ -911,9 +956,158 @@ tGrammar::initialize_filter() {
   S0.clear_stats();
 }
 
+bool
+tGrammar::undump_filter(dumper *f) {
+  int nrules = f->undump_int();
+  vector<grammar_rule *> rules(nrules);
+  int found = 0;
+  for(int i = 0; i < nrules; ++i) {
+    map<type_t, grammar_rule *>::iterator it = _rule_dict.find(f->undump_int());
+    if(it != _rule_dict.end()) {
+      rules[i] = it->second;
+      ++found;
+    }
+  }
+
+  // every active rule needs an entry, otherwise the filter would reject
+  // combinations it knows nothing about
+  if(found != (int) _rules.size()) {
+    LOG(logGrammar, INFO, "precomputed rule filter does not match the "
+        "grammar rules, recomputing");
+    return false;
+  }
+
+  // the subsumption filter is only valid for the deleted daughters it was
+  // computed with, and flop takes them from its own settings
+  int ndeleted = f->undump_int();
+  bool same_deleted = (ndeleted == length(_deleted_daughters));
+  for(int i = 0; same_deleted && i < ndeleted; ++i)
+    if(!contains(_deleted_daughters, f->undump_int()))
+      same_deleted = false;
+  if(!same_deleted) {
+    LOG(logGrammar, INFO, "precomputed rule filter was made with different "
+        "deleted daughters, recomputing");
+    return false;
+  }
+
+  _filter.resize(_rules.size());
+  _subsumption_filter.resize(_rules.size());
+
+  for(int m = 0; m < nrules; ++m) {
+    for(int d = 0; d < nrules; ++d) {
+      char unif = f->undump_char();
+      char subs = f->undump_char();
+      if(rules[m] == NULL || rules[d] == NULL) continue;
+      for(int arg = 1; arg <= 8; ++arg)
+        if(unif & (1 << (arg - 1)))
+          _filter.set(rules[m], rules[d], arg);
+      if(subs)
+        _subsumption_filter.set(rules[m], rules[d]);
+    }
+  }
+
+  return true;
+}
+
+/** The rule specific quick check slot file contains one line per rule
+ *  argument: the rule name, the argument number and the slots to test, most
+ *  selective first. Lines starting with `;' are comments. Rule arguments not
+ *  mentioned in the file keep using all slots.
+ */
+void
+tGrammar::read_qc_rule_slots(const string &filename) {
+  ifstream in(filename.c_str());
+  if(! in) {
+    LOG(logGrammar, WARN, "could not read quickcheck slots from `"
+        << filename << "'");
+    return;
+  }
+
+  int qc_len = fs::get_unif_qc_length();
+  int nargs = 0;
+  string line;
+  while(getline(in, line)) {
+    if(line.empty() || line[0] == ';') continue;
+    istringstream is(line);
+    string name;
+    int arg;
+    if(! (is >> name >> arg)) continue;
+    type_t t = lookup_type(name);
+    grammar_rule *rule = (t == T_BOTTOM) ? NULL : find_rule(t);
+    if(rule == NULL || arg < 1 || arg > rule->arity()) {
+      LOG(logGrammar, WARN, "ignoring quickcheck slots for unknown rule "
+          "argument `" << name << " " << arg << "'");
+      continue;
+    }
+
+    vector<int> slots;
+    int slot;
+    while(is >> slot)
+      if(slot >= 0 && slot < qc_len) slots.push_back(slot);
+
+    if(rule->_qc_slots_unif.empty()) {
+      // arguments without an entry test everything
+      rule->_qc_slots_unif.resize(rule->arity());
+      for(int a = 0; a < rule->arity(); ++a)
+        for(int i = 0; i < qc_len; ++i)
+          rule->_qc_slots_unif[a].push_back(i);
+    }
+    rule->_qc_slots_unif[arg - 1] = slots;
+    ++nargs;
+  }
+
+  LOG(logGrammar, INFO, "read quickcheck slots for " << nargs
+      << " rule arguments from `" << filename << "'");
+}
+
+namespace {
+  /** Order quick check slots by decreasing reject count */
+  struct qc_more_rejects {
+    const vector<unsigned int> &_rejects;
+    qc_more_rejects(const vector<unsigned int> &rejects)
+      : _rejects(rejects) {}
+    bool operator()(int a, int b) const { return _rejects[a] > _rejects[b]; }
+  };
+}
+
+void
+tGrammar::write_qc_rule_slots(const string &filename) {
+  ofstream out(filename.c_str());
+  if(! out) {
+    LOG(logGrammar, WARN, "could not write quickcheck slots to `"
+        << filename << "'");
+    return;
+  }
+
+  out << "; rule specific unification quickcheck slots: "
+      << "rule, argument, slots" << endl;
+  for(map<type_t, grammar_rule *>::iterator it = _rule_dict.begin();
+      it != _rule_dict.end(); ++it) {
+    grammar_rule *rule = it->second;
+    for(int a = 0; a < (int) rule->_qc_rejects_unif.size(); ++a) {
+      const vector<unsigned int> &rejects = rule->_qc_rejects_unif[a];
+      // slots that never rejected a pair for this argument are left out
+      vector<int> slots;
+      for(int i = 0; i < (int) rejects.size(); ++i)
+        if(rejects[i] > 0) slots.push_back(i);
+      // arguments that were never rejected keep testing all slots
+      if(slots.empty()) continue;
+      stable_sort(slots.begin(), slots.end(), qc_more_rejects(rejects));
+
+      out << type_name(rule->type()) << " " << a + 1;
+      for(vector<int>::iterator i = slots.begin(); i != slots.end(); ++i)
+        out << " " << *i;
+      out << endl;
+    }
+  }
+}
+
 
 tGrammar::~tGrammar()
 {
+    if(! get_opt_string("opt_compute_qc_rule_slots").empty())
+      write_qc_rule_slots(get_opt_string("opt_compute_qc_rule_slots"));
+
 #ifdef HAVE_ICU
     finalize_encoding_converter();
 #endif
@@ -936,6 +1130,7 @@ tGrammar::~tGrammar()
       delete r;
     }
 
+    fs::free_qc();
     dag_qc_free();
 
     delete _sm;
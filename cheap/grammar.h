@@ -128,6 +128,20 @@ class grammar_rule
     return _qc_vector_unif[arg - 1];
   }
 
+  /** Return the quick check slots to test for argument \a arg, most
+   *  selective first, or \c NULL if all slots have to be tested.
+   */
+  inline const std::vector<int> *qc_slots_unif(int arg) const {
+    return _qc_slots_unif.empty() ? NULL : &_qc_slots_unif[arg - 1];
+  }
+
+  /** Return the per slot reject counts for argument \a arg, or \c NULL if
+   *  the rule specific quick check slots are not being computed.
+   */
+  inline unsigned int *qc_rejects_unif(int arg) {
+    return _qc_rejects_unif.empty() ? NULL : &_qc_rejects_unif[arg - 1][0];
+  }
+
   /** Should this rule be treated special when using hyperactive parsing?
    *  Rules whose active items are seldom reused should be made hyperactive
    *  because one dag copying operation is much more expensive than several
@@ -170,6 +184,15 @@ class grammar_rule
   qc_vec *_qc_vector_unif;
   void init_qc_vector_unif();
 
+  /** The rule specific quick check slots for every argument (empty if the
+   *  global quick check is used)
+   */
+  std::vector< std::vector<int> > _qc_slots_unif;
+  /** For every argument and quick check slot, the number of pairs the slot
+   *  rejected (only while computing rule specific slots)
+   */
+  std::vector< std::vector<unsigned int> > _qc_rejects_unif;
+
   bool _hyper;
   bool _spanningonly;
 
@@ -461,6 +484,21 @@ public:
   rulefilter _filter;
   rulefilter _subsumption_filter;
   void initialize_filter();
+  /** Load the rule filters precomputed by flop from section
+   *  \c SEC_RULEFILTER. \return \c false if they do not match the rules or
+   *  the deleted daughters of this grammar, in which case
+   *  initialize_filter() has to be used.
+   */
+  bool undump_filter(dumper *f);
+
+  /** Read the rule specific unification quick check slots from \a filename,
+   *  as written by write_qc_rule_slots().
+   */
+  void read_qc_rule_slots(const std::string &filename);
+  /** Write the rule specific unification quick check slots, as derived from
+   *  the reject counts recorded during parsing, to \a filename.
+   */
+  void write_qc_rule_slots(const std::string &filename);
 
   list_int *_deleted_daughters;
   class restrictor *_packing_restrictor;
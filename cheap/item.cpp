@@ -104,6 +104,8 @@ struct charz_t {
 static charz_t cfrom, cto;
 static bool charz_init = false;
 static bool charz_use = false;
+/** The attributes characterize() fills, if it is in use */
+static list_int *charz_attributes = NULL;
 
 /** Set characterization paths and modlist. */
 void init_characterization() {
@@ -114,11 +116,20 @@ void init_characterization() {
     cto.set(cto_path);
     charz_init = true;
     charz_use = ! get_opt_string("opt_mrs").empty();
+    free_list(charz_attributes);
+    charz_attributes = NULL;
+    if(charz_use)
+      charz_attributes = cons(cfrom.attribute, cons(cto.attribute, NULL));
   }
 }
 
 void finalize_characterization() {
-  // nothing to do
+  free_list(charz_attributes);
+  charz_attributes = NULL;
+}
+
+const list_int *characterization_attributes() {
+  return charz_attributes;
 }
 
 inline bool characterize(fs &thefs, int from, int to) {
@@ -133,9 +144,18 @@ inline bool characterize(fs &thefs, int from, int to) {
 }
 #else
 #define characterize(fs, start, end)
+
+const list_int *characterization_attributes() {
+  return NULL;
+}
 #endif
 
 item_owner *tItem::_default_owner = NULL;
+
+pool_allocator *item_pool() {
+  item_owner *owner = tItem::default_owner();
+  return (owner != NULL) ? &owner->pool() : NULL;
+}
 int tItem::_next_id = 1;
 
 tItem::tItem(int start, int end, const tPaths &paths,
@@ -145,7 +165,7 @@ tItem::tItem(int start, int end, const tPaths &paths,
       _spanningonly(false), _paths(paths),
       _fs(f), _tofill(0), _nfilled(0), _inflrs_todo(0), _prefix_lrs(0),
       _result_root(-1), _result_contrib(false),
-      _qc_vector_unif(0), _qc_vector_subs(0),
+      _qc_vector_unif(0), _qc_vector_subs(0), _fingerprint(0),
       _score(0.0), _gmscore(0.0), _printname(printname),
       _blocked(0), _unpack_cache(0), parents(), packed(), _chart(0)
 {
@@ -158,7 +178,7 @@ tItem::tItem(int start, int end, const tPaths &paths,
       _start(start), _end(end), _spanningonly(false), _paths(paths),
       _fs(), _tofill(0), _nfilled(0), _inflrs_todo(0), _prefix_lrs(0),
       _result_root(-1), _result_contrib(false),
-      _qc_vector_unif(0), _qc_vector_subs(0),
+      _qc_vector_unif(0), _qc_vector_subs(0), _fingerprint(0),
       _score(0.0), _gmscore(0.0), _printname(printname),
       _blocked(0), _unpack_cache(0), parents(), packed(), _chart(0)
 {
@@ -445,13 +465,15 @@ void tLexItem::init() {
     // ++stats.words;
 
     _qc_vector_unif = _fs_full.get_unif_qc_vector();
-    _qc_vector_subs = _fs_full.get_subs_qc_vector();
 
     // compute _score score for lexical items
     if(Grammar->sm())
       score(Grammar->sm()->scoreLeaf(this));
 
     characterize(_fs, _startposition, _endposition);
+    // the subsumption quick check has to see the structure that packing
+    // compares, i.e., the restricted and characterized one
+    _qc_vector_subs = _fs.get_subs_qc_vector();
   }
 
 #ifdef PETDEBUG
@@ -566,9 +588,9 @@ tPhrasalItem::tPhrasalItem(grammar_rule *R, tItem *pasv, fs &f)
   // rule stuff + characterization
   if(passive()) {
     _qc_vector_unif = f.get_unif_qc_vector();
-    _qc_vector_subs = f.get_subs_qc_vector();
     R->passives++;
     characterize(_fs, _startposition, _endposition);
+    _qc_vector_subs = _fs.get_subs_qc_vector();
   } else {
     _qc_vector_unif = f.get_unif_qc_vector(nextarg());
     R->actives++;
@@ -618,8 +640,8 @@ tPhrasalItem::tPhrasalItem(tPhrasalItem *active, tItem *pasv, fs &f)
     // rule stuff
     if(passive()) {
       _qc_vector_unif = f.get_unif_qc_vector();
-      _qc_vector_subs = f.get_subs_qc_vector();
       characterize(_fs, _startposition, _endposition);
+      _qc_vector_subs = _fs.get_subs_qc_vector();
       active->rule()->passives++;
     } else {
       _qc_vector_unif = f.get_unif_qc_vector(nextarg());
@@ -645,6 +667,8 @@ tPhrasalItem::tPhrasalItem(tPhrasalItem *sponsor, vector<tItem *> &dtrs, fs &f)
     _trait = SYNTAX_TRAIT;
     _nfilled = dtrs.size();
     _result_root = sponsor->result_root();
+    // for the quick check when this item is a daughter in unpacking
+    _qc_vector_unif = f.get_unif_qc_vector();
 }
 
 
@@ -1130,13 +1154,75 @@ tPhrasalItem::unpack_combine(vector<tItem *> &daughters) {
   return result;
 }
 
+vector<item_list> tPathTable::_paths;
+map<item_list, int> tPathTable::_ids;
+HASH_SPACE::hash_map<std::pair<int, tItem *>, int, tPathTable::extension_hash>
+  tPathTable::_extensions;
+unsigned int tPathTable::_gplevel = 0;
+
+int
+tPathTable::intern(const item_list &path) {
+  map<item_list, int>::iterator it = _ids.find(path);
+  if (it != _ids.end())
+    return it->second;
+  int id = _paths.size();
+  _paths.push_back(path);
+  _ids[path] = id;
+  return id;
+}
+
+int
+tPathTable::root(unsigned int gplevel) {
+  item_list path;
+  if (gplevel > 0)
+    path.push_back(NULL);
+  return intern(path);
+}
+
+int
+tPathTable::extend(int path, tItem *item, unsigned int gplevel) {
+  if (gplevel != _gplevel) {
+    // e.g., unpacking with the PCFG, which does not use grandparenting
+    _extensions.clear();
+    _gplevel = gplevel;
+  }
+  std::pair<int, tItem *> key(path, item);
+  HASH_SPACE::hash_map<std::pair<int, tItem *>, int, extension_hash>::iterator
+    it = _extensions.find(key);
+  if (it != _extensions.end())
+    return it->second;
+
+  item_list newpath = _paths[path];
+  newpath.push_back(item);
+  while (newpath.size() > gplevel)
+    newpath.pop_front();
+  int id = intern(newpath);
+  _extensions[key] = id;
+  return id;
+}
+
+void
+tPathTable::clear() {
+  _paths.clear();
+  _ids.clear();
+  _extensions.clear();
+}
+
+void
+tPathTable::swap(tables &other) {
+  _paths.swap(other.paths);
+  _ids.swap(other.ids);
+  _extensions.swap(other.extensions);
+  std::swap(_gplevel, other.gplevel);
+}
+
 tHypothesis *
-tInputItem::hypothesize_edge(list<tItem*> path, unsigned int i) {
+tInputItem::hypothesize_edge(int path, unsigned int i) {
   return NULL;
 }
 
 tHypothesis *
-tLexItem::hypothesize_edge(list<tItem*> path, unsigned int i) {
+tLexItem::hypothesize_edge(int path, unsigned int i) {
   if (i == 0) {
     if (_hypo == NULL) {
       _hypo = new tHypothesis(this);
@@ -1150,7 +1236,7 @@ tLexItem::hypothesize_edge(list<tItem*> path, unsigned int i) {
 }
 
 tHypothesis *
-tPhrasalItem::hypothesize_edge(list<tItem*> path, unsigned int i)
+tPhrasalItem::hypothesize_edge(int path, unsigned int i)
 {
   tHypothesis *hypo = NULL;
 
@@ -1161,43 +1247,40 @@ tPhrasalItem::hypothesize_edge(list<tItem*> path, unsigned int i)
       return hypo;
   }
 
-  // Only check the path length no longer than the opt_gplevel
-  while (path.size() > opt_gplevel)
-    path.pop_front();
-
-  if (_hypo_agendas.find(path) == _hypo_agendas.end()) {
+  int k = find_hypo_path(path);
+  if (k < 0) {
     // This is a new path:
     // * initialize the agenda
     // * score the hypotheses
     // * create the hypothese cache
-    _hypo_agendas[path].clear();
+    k = _hypo_paths.size();
+    _hypo_paths.push_back(tPathHypotheses(path));
     for (vector<tHypothesis*>::iterator h = _hypotheses.begin();
          h != _hypotheses.end(); ++h) {
       Grammar->sm()->score_hypothesis(*h, path, opt_gplevel);
-      hagenda_insert(_hypo_agendas[path], *h, path);
+      hagenda_insert(_hypo_paths[k].agenda, *h, path);
     }
-    _hypo_path_max[path] = UINT_MAX;
   }
+  // the recursive calls below are on other items and do not touch
+  // _hypo_paths, so this reference stays valid
+  tPathHypotheses &ph = _hypo_paths[k];
 
   // Check cached hypotheses
-  if (i < _hypotheses_path[path].size() && _hypotheses_path[path][i])
-    return _hypotheses_path[path][i];
+  if (i < ph.hypotheses.size() && ph.hypotheses[i])
+    return ph.hypotheses[i];
 
   // Quick return for failed hypothesis
-  if (i >= _hypo_path_max[path])
+  if (i >= ph.max)
     return NULL;
 
   // Create new path for daughters
-  list<tItem*> newpath = path;
-  newpath.push_back(this);
-  if (newpath.size() > opt_gplevel)
-    newpath.pop_front();
+  int newpath = tPathTable::extend(path, this, opt_gplevel);
 
   // Initialize the set of decompositions and pushing initial
   // hypotheses onto the local agenda when called on an edge for the
   // first time.  This initialization should only be done for the
   // first hypothesis of the first path, as for the following path(s).
-  if (i == 0 && _hypotheses_path.size() == 1) {
+  if (i == 0 && _hypo_paths.size() == 1) {
     decompose_edge();
     for (list<tDecomposition*>::iterator decomposition = decompositions.begin();
          decomposition != decompositions.end(); ++decomposition) {
@@ -1220,9 +1303,9 @@ tPhrasalItem::hypothesize_edge(list<tItem*> path, unsigned int i)
     }
   }
 
-  while (!_hypo_agendas[path].empty() && i >= _hypotheses_path[path].size()) {
-    hypo = _hypo_agendas[path].front();
-    _hypo_agendas[path].pop_front();
+  while (!ph.agenda.empty() && i >= ph.hypotheses.size()) {
+    hypo = ph.agenda.front();
+    ph.agenda.pop_front();
     list<vector<int> > indices_adv = advance_indices(hypo->indices);
 
     while (!indices_adv.empty()) {
@@ -1265,15 +1348,15 @@ tPhrasalItem::hypothesize_edge(list<tItem*> path, unsigned int i)
         new_hypothesis(hypo->decomposition, dtrs, indices);
     }
     //    if (!hypo->inst_failed) // this will cause missing readings when used with grandparenting
-    _hypotheses_path[path].push_back(hypo);
+    ph.hypotheses.push_back(hypo);
   }
-  if (i < _hypotheses_path[path].size()){
-    if (_hypo_agendas[path].size() == 0)
-      _hypo_path_max[path] = _hypotheses_path[path].size();
-    return _hypotheses_path[path][i];
+  if (i < ph.hypotheses.size()){
+    if (ph.agenda.empty())
+      ph.max = ph.hypotheses.size();
+    return ph.hypotheses[i];
   }
   else {
-    _hypo_path_max[path] = _hypotheses_path[path].size();
+    ph.max = ph.hypotheses.size();
     return NULL;
   }
   //  return hypo;
@@ -1325,10 +1408,10 @@ tPhrasalItem::new_hypothesis(tDecomposition* decomposition,
   tHypothesis *hypo = new tHypothesis(this, decomposition, dtrs, indices);
   stats.p_hypotheses ++;
   _hypotheses.push_back(hypo);
-  for (map<list<tItem*>, list<tHypothesis*> >::iterator iter = _hypo_agendas.begin();
-       iter != _hypo_agendas.end(); ++iter) {
-    Grammar->sm()->score_hypothesis(hypo, (*iter).first, opt_gplevel);
-    hagenda_insert(_hypo_agendas[(*iter).first], hypo, (*iter).first);
+  for (vector<tPathHypotheses>::iterator ph = _hypo_paths.begin();
+       ph != _hypo_paths.end(); ++ph) {
+    Grammar->sm()->score_hypothesis(hypo, ph->path, opt_gplevel);
+    hagenda_insert(ph->agenda, hypo, ph->path);
   }
 }
 
@@ -1424,95 +1507,150 @@ list<tItem *>
 tItem::selectively_unpack(list<tItem*> roots, int nsolutions,
                           int end, int upedgelimit, long memlimit)
 {
-  item_list results;
   if (nsolutions <= 0)
-    return results;
+    return item_list();
+  tSelectiveUnpacker unpacker(roots, end, upedgelimit, memlimit);
+  return unpacker.next(nsolutions);
+}
 
-  list<tHypothesis*> ragenda;
+tSelectiveUnpacker::tSelectiveUnpacker(const item_list &roots, int end,
+                                       int upedgelimit, long memlimit)
+  : _last(NULL), _path(tPathTable::root(opt_gplevel)), _end(end),
+    _upedgelimit(upedgelimit), _memlimit(memlimit)
+{
   tHypothesis* aitem;
-
   tHypothesis* hypo;
-  list<tItem*> path;
-  path.push_back(NULL); // root path
-  while (path.size() > opt_gplevel)
-    path.pop_front();
 
-  for (item_iter it = roots.begin(); it != roots.end(); ++it) {
+  for (item_citer it = roots.begin(); it != roots.end(); ++it) {
     tPhrasalItem* root = (tPhrasalItem*)(*it);
-    hypo = (*it)->hypothesize_edge(path, 0);
+    hypo = (*it)->hypothesize_edge(_path, 0);
 
     if (hypo) {
-      // Grammar->sm()->score_hypothesis(hypo);
       aitem = new tHypothesis(root, hypo, 0);
       stats.p_hypotheses ++;
-      hagenda_insert(ragenda, aitem, path);
+      hagenda_insert(_agenda, aitem, _path);
     }
     for (item_iter edge = root->packed.begin();
          edge != root->packed.end(); ++edge) {
       // ignore frozen edges
       if ((*edge)->frozen())
         continue;
-      hypo = (*edge)->hypothesize_edge(path, 0);
+      hypo = (*edge)->hypothesize_edge(_path, 0);
       if (!hypo)
         continue;
-      //Grammar->sm()->score_hypothesis(hypo);
       aitem = new tHypothesis(*edge, hypo, 0);
       stats.p_hypotheses ++;
-      hagenda_insert(ragenda, aitem, path);
+      hagenda_insert(_agenda, aitem, _path);
     }
   }
+}
 
-  while (!ragenda.empty() && nsolutions > 0) {
-    aitem = ragenda.front();
-    ragenda.pop_front();
-    tItem *result = aitem->edge->instantiate_hypothesis(path, aitem->hypo_dtrs.front(), upedgelimit, memlimit);
-    if (upedgelimit > 0 && stats.p_upedges > upedgelimit) {
+tSelectiveUnpacker::~tSelectiveUnpacker()
+{
+  delete _last;
+  for (list<tHypothesis*>::iterator it = _agenda.begin();
+       it != _agenda.end(); ++it)
+    delete *it;
+}
+
+void
+tSelectiveUnpacker::advance(tHypothesis *aitem)
+{
+  tHypothesis *hypo
+    = aitem->edge->hypothesize_edge(_path, aitem->indices[0]+1);
+  if (hypo) {
+    tHypothesis* naitem
+      = new tHypothesis(aitem->edge, hypo, aitem->indices[0]+1);
+    stats.p_hypotheses ++;
+    hagenda_insert(_agenda, naitem, _path);
+  }
+  delete aitem;
+}
+
+item_list
+tSelectiveUnpacker::next(int n)
+{
+  item_list results;
+  if (n <= 0)
+    return results;
+
+  // the successor of the last reading is only needed now
+  if (_last != NULL) {
+    advance(_last);
+    _last = NULL;
+  }
+
+  while (!_agenda.empty()) {
+    tHypothesis *aitem = _agenda.front();
+    _agenda.pop_front();
+    tItem *result = aitem->edge->instantiate_hypothesis(
+      _path, aitem->hypo_dtrs.front(), _upedgelimit, _memlimit);
+    if (_upedgelimit > 0 && stats.p_upedges > _upedgelimit) {
+      // out of edges: nothing more can be unpacked from this forest
+      delete aitem;
+      for (list<tHypothesis*>::iterator it = _agenda.begin();
+           it != _agenda.end(); ++it)
+        delete *it;
+      _agenda.clear();
       return results;
     }
     type_t rule;
     if (result &&
-        (result->trait() == PCFG_TRAIT || result->root(Grammar, end, rule))) {
+        (result->trait() == PCFG_TRAIT || result->root(Grammar, _end, rule))) {
       result->set_result_root(rule);
       results.push_back(result);
-      --nsolutions;
-      if (nsolutions == 0) {
-        delete aitem;
+      if (--n == 0) {
+        _last = aitem;
         break;
       }
     }
-
-    hypo = aitem->edge->hypothesize_edge(path, aitem->indices[0]+1);
-    if (hypo) {
-      //Grammar->sm()->score_hypothesis(hypo);
-      tHypothesis* naitem = new tHypothesis(aitem->edge, hypo, aitem->indices[0]+1);
-      stats.p_hypotheses ++;
-      hagenda_insert(ragenda, naitem, path);
-    }
-    delete aitem;
+    advance(aitem);
   }
 
-  //_fix_me release memory allocated
-  for (list<tHypothesis*>::iterator it = ragenda.begin();
-       it != ragenda.end(); ++it)
-    delete *it;
-
   return results;
 }
 
 tItem*
-tInputItem::instantiate_hypothesis(list<tItem*> path, tHypothesis * hypo, int upedgelimit, long memlimit) {
-  score(hypo->scores[path]);
+tInputItem::instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit) {
+  score(hypo->score(path));
   return this;
 }
 
 tItem *
-tLexItem::instantiate_hypothesis(list<tItem*> path, tHypothesis * hypo, int upedgelimit, long memlimit) {
-  score(hypo->scores[path]);
+tLexItem::instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit) {
+  score(hypo->score(path));
   return this;
 }
 
+/** Check the rule filter and the unification quick check of \a R with the
+ *  instantiated \a daughters before the unifications are replayed. Both are
+ *  necessary conditions for the unifications to succeed, and much cheaper
+ *  than finding out by unifying.
+ */
+static bool
+unpack_filter(grammar_rule *R, const vector<tItem*> &daughters)
+{
+  bool qc = fs::get_unif_qc_length() != 0;
+  for (list_int *args = R->allargs(); args != 0; args = rest(args)) {
+    int arg = first(args);
+    tItem *dtr = daughters[arg - 1];
+    if (! Grammar->filter_compatible(R, arg, dtr->rule()))
+      return false;
+    if (qc && dtr->qc_vector_unif() != NULL) {
+      const vector<int> *slots = R->qc_slots_unif(arg);
+      if (slots != NULL
+          ? ! fs::qc_compatible_unif(dtr->qc_vector_unif(),
+                                     R->qc_vector_unif(arg), *slots)
+          : ! fs::qc_compatible_unif(dtr->qc_vector_unif(),
+                                     R->qc_vector_unif(arg)))
+        return false;
+    }
+  }
+  return true;
+}
+
 tItem *
-tPhrasalItem::instantiate_hypothesis(list<tItem*> path, tHypothesis * hypo, int upedgelimit, long memlimit)
+tPhrasalItem::instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit)
 {
 
   // Check if we reached the unpack edge limit. Caller is responsible for
@@ -1532,14 +1670,7 @@ tPhrasalItem::instantiate_hypothesis(list<tItem*> path, tHypothesis * hypo, int
 
   vector<tItem*> daughters;
 
-  // Only check the path length no longer than the opt_gplevel
-  while (path.size() > opt_gplevel)
-    path.pop_front();
-
-  list<tItem*> newpath = path;
-  newpath.push_back(this);
-  if (newpath.size() > opt_gplevel)
-    newpath.pop_front();
+  int newpath = tPathTable::extend(path, this, opt_gplevel);
 
   // Instantiate all the sub hypotheses.
   for (list<tHypothesis*>::iterator subhypo = hypo->hypo_dtrs.begin();
@@ -1555,6 +1686,14 @@ tPhrasalItem::instantiate_hypothesis(list<tItem*> path, tHypothesis * hypo, int
 
   tPhrasalItem *result;
   if (trait() != PCFG_TRAIT) {
+    if (! unpack_filter(rule(), daughters)) {
+#ifdef INSTFC
+      propagate_failure(hypo);
+#endif
+      stats.p_failures ++;
+      return NULL;
+    }
+
     // Replay the unification.
     fs res = rule()->instantiate(true);
     list_int *tofill = rule()->allargs();
@@ -1597,7 +1736,7 @@ tPhrasalItem::instantiate_hypothesis(list<tItem*> path, tHypothesis * hypo, int
   }
 
   stats.p_upedges++;
-  result->score(hypo->scores[path]);
+  result->score(hypo->score(path));
   hypo->inst_edge = result;
   return result;
 }
@@ -1623,7 +1762,7 @@ list<vector<int> > advance_indices(vector<int> indices) {
   return results;
 }
 
-void hagenda_insert(list<tHypothesis*> &agenda, tHypothesis* hypo, list<tItem*> path) {
+void hagenda_insert(list<tHypothesis*> &agenda, tHypothesis* hypo, int path) {
   if (agenda.empty()) {
     agenda.push_back(hypo);
     return;
@@ -1631,7 +1770,7 @@ void hagenda_insert(list<tHypothesis*> &agenda, tHypothesis* hypo, list<tItem*>
   int flag = 0;
   for (list<tHypothesis*>::iterator it = agenda.begin();
        it != agenda.end(); ++it) {
-    if (hypo->scores[path] > (*it)->scores[path]) {
+    if (hypo->score(path) > (*it)->score(path)) {
       agenda.insert(it, hypo);
       flag = 1;
       break;
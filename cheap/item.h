@@ -30,6 +30,7 @@
 #include "fs.h"
 #include "fs-chart.h"
 #include "grammar.h"
+#include "pool-alloc.h"
 #include "paths.h"
 #include "postags.h"
 #include "hashing.h"
@@ -53,6 +54,18 @@ class tAbstractItemPrinter;
 /** this is a hoax to get the cfrom and cto values into the mrs */
 void init_characterization();
 
+/** The attributes whose values characterization stamps into the feature
+ *  structures of lexical items (the last attributes of the cfrom and cto
+ *  paths), or \c NULL if characterization is not used.
+ */
+const list_int *characterization_attributes();
+
+/** The arena of the current item owner (see tItem::default_owner()), where
+ *  new items and their hypotheses are allocated, or \c NULL if there is no
+ *  owner and the system heap is used.
+ */
+pool_allocator *item_pool();
+
 /** Inhibit assignment operator and copy constructor(always throws an error) */
 #define INHIBIT_COPY_ASSIGN(___Type) \
   virtual ___Type &operator=(const ___Type &i) { \
@@ -74,26 +87,110 @@ typedef std::list< tInputItem * > inp_list;
 /** Iterator for inp_list */
 typedef inp_list::iterator inp_iterator;
 
+/** Interned grandparenting paths for selective unpacking.
+ *
+ * A grandparenting path is the list of the (at most \c gplevel) nearest
+ * ancestors of a hypothesis. The hypothesis tables of the items and the
+ * scores of the hypotheses are keyed by small integer path ids rather than
+ * by the lists themselves, so that a path is copied and compared only the
+ * first time it is reached. The table is cleared at the start of every
+ * parse, ids must not be kept longer than the chart items they refer to.
+ */
+class tPathTable
+{
+public:
+  /** Return the id of the path of the root hypotheses */
+  static int root(unsigned int gplevel);
+
+  /** Return the id of the path \a path extended by \a item, keeping only
+   *  the \a gplevel nearest ancestors.
+   */
+  static int extend(int path, tItem *item, unsigned int gplevel);
+
+  /** Return the ancestors of the path with id \a path, the nearest last */
+  static const item_list &path(int path) { return _paths[path]; }
+
+  /** Forget all paths */
+  static void clear();
+
+  struct extension_hash {
+    inline size_t operator()(const std::pair<int, tItem *> &key) const {
+      return (size_t) key.second + 31 * (size_t) key.first;
+    }
+  };
+
+  /** The paths of a parse that is not the current one, see tParseContext */
+  struct tables {
+    std::vector<item_list> paths;
+    std::map<item_list, int> ids;
+    HASH_SPACE::hash_map<std::pair<int, tItem *>, int, extension_hash>
+      extensions;
+    unsigned int gplevel;
+
+    tables() : gplevel(0) {}
+  };
+
+  /** Exchange the current paths with the ones saved in \a other */
+  static void swap(tables &other);
+
+private:
+  static int intern(const item_list &path);
+
+  /** The paths, indexed by their id */
+  static std::vector<item_list> _paths;
+  /** The ids of the paths */
+  static std::map<item_list, int> _ids;
+  /** Cache for extend(), valid for \c _gplevel */
+  static HASH_SPACE::hash_map<std::pair<int, tItem *>, int, extension_hash>
+    _extensions;
+  static unsigned int _gplevel;
+};
+
 /** Represent a possible (not necessarily valid) decomposition of an
     item. */
 struct tDecomposition
 {
 public:
+  POOL_ALLOCATED(item_pool())
+
   std::set< std::vector<int> > indices;
   item_list rhs;
+  /** The scores of the local features of the hypotheses with this
+   *  decomposition for the (interned) grandparenting paths, which are the
+   *  same for all of them (see tSM::score_hypothesis()) */
+  std::vector<std::pair<int, double> > local_scores;
   tDecomposition(item_list rhs) {
     this->rhs = rhs;
   }
   tDecomposition(tItem* dtr) {
     this->rhs.push_back(dtr);
   }
+
+  /** Set \a score to the local score for path \a path.
+   *  \return \c false if there is none yet */
+  bool local_score(int path, double &score) const {
+    for (std::vector<std::pair<int, double> >::const_iterator it
+           = local_scores.begin(); it != local_scores.end(); ++it)
+      if (it->first == path) { score = it->second; return true; }
+    return false;
+  }
+
+  /** Set the local score for path \a path */
+  void set_local_score(int path, double score) {
+    local_scores.push_back(std::make_pair(path, score));
+  }
 };
 
 /** Represent a hypothesis with which the item is constructed. */
 struct tHypothesis
 {
 public:
-  std::map<item_list,double> scores;
+  POOL_ALLOCATED(item_pool())
+
+  /** The scores of this hypothesis for the (interned) grandparenting paths
+   *  it has been scored for. There are only a few, so a vector is faster
+   *  than any map. */
+  std::vector<std::pair<int, double> > scores;
   tItem* edge;
   tItem* inst_edge;
   bool inst_failed;
@@ -134,6 +231,30 @@ public:
     //hdtr->hypo_parents.push_back(this);
     indices.push_back(idx);
   }
+
+  /** Return true if this hypothesis has been scored for path \a path */
+  bool scored(int path) const {
+    for (std::vector<std::pair<int, double> >::const_iterator it
+           = scores.begin(); it != scores.end(); ++it)
+      if (it->first == path) return true;
+    return false;
+  }
+
+  /** Return the score for path \a path, zero if not scored yet */
+  double score(int path) const {
+    for (std::vector<std::pair<int, double> >::const_iterator it
+           = scores.begin(); it != scores.end(); ++it)
+      if (it->first == path) return it->second;
+    return 0.0;
+  }
+
+  /** Set the score for path \a path */
+  void set_score(int path, double s) {
+    for (std::vector<std::pair<int, double> >::iterator it = scores.begin();
+         it != scores.end(); ++it)
+      if (it->first == path) { it->second = s; return; }
+    scores.push_back(std::make_pair(path, s));
+  }
 };
 
 
@@ -167,6 +288,10 @@ public:
 
   INHIBIT_COPY_ASSIGN(tItem);
 
+  // items are taken from the arena of their owner, which releases them all
+  // at once
+  POOL_ALLOCATED(item_pool())
+
   /** Set the owner of all created items to be able to handle destruction
    *  properly.
    */
@@ -176,6 +301,10 @@ public:
 
   /** Reset the global counter for the creation of unique internal item ids */
   static void reset_ids() { _next_id = 1; }
+  /** Return the id the next item will get */
+  static int next_id() { return _next_id; }
+  /** Set the id the next item will get */
+  static void next_id(int id) { _next_id = id; }
 
   /** Return the unique internal id of this item */
   inline int id() const { return _id; }
@@ -426,6 +555,19 @@ public:
    */
   inline const qc_vec &qc_vector_subs() const { return _qc_vector_subs; }
 
+  /** Return the structural fingerprint of the feature structure of this
+   *  item, computed on first use (see dag_fingerprint()). The character
+   *  positions stamped in by characterization are left out, so the same
+   *  lexical item (or rule chain) gets the same fingerprint at every
+   *  position of every input.
+   */
+  unsigned long long fingerprint() {
+    if(_fingerprint == 0)
+      _fingerprint = dag_fingerprint(get_fs().dag(),
+                                     characterization_attributes());
+    return _fingerprint;
+  }
+
   /** \brief Return the rule this item was built from. This returns values
    *  different from \c NULL only for phrasal items.
    */
@@ -523,11 +665,12 @@ protected:
   virtual item_list unpack1(int limit) = 0;
 
   /** \brief Base function called by selectively_unpack to generate
-   *   the \a i th best hypothesys with specific head \a path .
+   *   the \a i th best hypothesys with specific head \a path (an id from
+   *   tPathTable).
    *
    *  \return the \a i th best hypothesis of the item
    */
-  virtual tHypothesis * hypothesize_edge(item_list path, unsigned int i) = 0;
+  virtual tHypothesis * hypothesize_edge(int path, unsigned int i) = 0;
 
   /** \brief Base function that instantiate the hypothesis (and
    *   recursively instantiate its sub-hypotheses) until \a upedgelimit
@@ -535,7 +678,7 @@ protected:
    *
    *  \return the instantiated item from the hypothesis
    */
-  virtual tItem * instantiate_hypothesis(item_list path, tHypothesis * hypo, int upedgelimit, long memlimit) = 0;
+  virtual tItem * instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit) = 0;
 
 private:
   /**
@@ -591,6 +734,9 @@ private:
   qc_vec _qc_vector_unif;
   qc_vec _qc_vector_subs;
 
+  /** cached result of fingerprint(), 0 if not yet computed */
+  unsigned long long _fingerprint;
+
   double _score;
   double _gmscore;
 
@@ -613,6 +759,7 @@ public:
   friend class tInputItem;
   friend class tLexItem;
   friend class tPhrasalItem;
+  friend class tSelectiveUnpacker;
 
   friend class tAbstractItemPrinter;
 
@@ -857,8 +1004,8 @@ public:
 
   /** \brief tInputItem will not have items packed into them. They
       need not be unpacked. */
-  virtual tHypothesis * hypothesize_edge(std::list<tItem*> path, unsigned int i);
-  virtual tItem * instantiate_hypothesis(std::list<tItem*> path, tHypothesis * hypo, int upedgelimit, long memlimit);
+  virtual tHypothesis * hypothesize_edge(int path, unsigned int i);
+  virtual tItem * instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit);
   //  virtual item_list selectively_unpack(int n, int upedgelimit);
 
   /** Return the external id associated with this item */
@@ -1030,8 +1177,8 @@ protected:
   /** \brief Return the \a i th best hypothesis. For tLexItem, there
    *   is always only one hypothesis, for a given \a path .
    */
-  virtual tHypothesis * hypothesize_edge(std::list<tItem*> path, unsigned int i);
-  virtual tItem * instantiate_hypothesis(std::list<tItem*> path, tHypothesis * hypo, int upedgelimit, long memlimit);
+  virtual tHypothesis * hypothesize_edge(int path, unsigned int i);
+  virtual tItem * instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit);
   //  virtual item_list selectively_unpack(int n, int upedgelimit);
 
 private:
@@ -1192,10 +1339,10 @@ protected:
   //  virtual item_list selectively_unpack(int n, int upedgelimit);
 
   /** Get the \i th best hypothesis of the item with \a path to root. */
-  virtual tHypothesis * hypothesize_edge(std::list<tItem*> path, unsigned int i);
+  virtual tHypothesis * hypothesize_edge(int path, unsigned int i);
 
   /** Instantiatve the hypothesis */
-  virtual tItem * instantiate_hypothesis(std::list<tItem*> path, tHypothesis * hypo, int upedgelimit, long memlimit);
+  virtual tItem * instantiate_hypothesis(int path, tHypothesis * hypo, int upedgelimit, long memlimit);
 
   /** Decompose edge and return the number of decompositions
    * All the decompositions are recorded in this->decompositions .
@@ -1213,13 +1360,30 @@ private:
 
   /** A vector of hypotheses*/
   std::vector<tHypothesis*> _hypotheses;
-  /** a map from path to corresponding cached hypotheses */
-  std::map<std::list<tItem*>,std::vector<tHypothesis*> > _hypotheses_path;
-  /** a map from path to corresponding max number of hypothese */
-  std::map<std::list<tItem*>,unsigned int> _hypo_path_max;
 
-  /** Hypothesis agenda*/
-  std::map<std::list<tItem*>,std::list<tHypothesis*> > _hypo_agendas;
+  /** The hypotheses of this item for one grandparenting path */
+  struct tPathHypotheses {
+    tPathHypotheses(int p) : path(p), max(UINT_MAX) {}
+    /** The id of the path */
+    int path;
+    /** The cached hypotheses */
+    std::vector<tHypothesis*> hypotheses;
+    /** The max number of hypotheses */
+    unsigned int max;
+    /** Hypothesis agenda */
+    std::list<tHypothesis*> agenda;
+  };
+
+  /** The hypotheses per path, in the order the paths were reached */
+  std::vector<tPathHypotheses> _hypo_paths;
+
+  /** Return the index of \a path in _hypo_paths, or -1 if it was not
+   *  reached yet */
+  int find_hypo_path(int path) const {
+    for (unsigned int k = 0; k < _hypo_paths.size(); ++k)
+      if (_hypo_paths[k].path == path) return k;
+    return -1;
+  }
 
   /** A list of decompositions */
   std::list<tDecomposition*> decompositions;
@@ -1241,7 +1405,49 @@ std::list<std::vector<int> > advance_indices(std::vector<int> indices);
 /** Insert hypothesis into agenda. Agenda is sorted descendingly
  *
  */
-void hagenda_insert(std::list<tHypothesis*> &agenda, tHypothesis* hypo, std::list<tItem*> path);
+void hagenda_insert(std::list<tHypothesis*> &agenda, tHypothesis* hypo, int path);
+
+/** Resumable selective unpacking of a packed forest.
+ *
+ * The unpacker keeps the agenda of root hypotheses between calls, so the
+ * readings can be taken from the forest one by one, in the order of their
+ * scores, as far as a client actually needs them. The forest (the chart
+ * items of \a roots and their hypotheses) must stay alive as long as the
+ * unpacker is used.
+ */
+class tSelectiveUnpacker {
+public:
+  /** Hypothesize the \a roots, which are checked to be roots that end at
+   *  \a end when they are unpacked. \a upedgelimit and \a memlimit are the
+   *  resource limits of all subsequent next() calls together.
+   */
+  tSelectiveUnpacker(const item_list &roots, int end, int upedgelimit,
+                     long memlimit);
+  ~tSelectiveUnpacker();
+
+  /** Unpack the next (at most) \a n readings */
+  item_list next(int n);
+
+  /** \c true if no more readings can be unpacked */
+  bool exhausted() const {
+    return _last == NULL && _agenda.empty();
+  }
+
+private:
+  tSelectiveUnpacker(const tSelectiveUnpacker &);
+  tSelectiveUnpacker &operator=(const tSelectiveUnpacker &);
+
+  /** Push the successor of \a aitem onto the agenda and delete it */
+  void advance(tHypothesis *aitem);
+
+  std::list<tHypothesis*> _agenda;
+  /** The hypothesis of the last reading, whose successor is only put on the
+   *  agenda when more readings are requested
+   */
+  tHypothesis *_last;
+  int _path, _end, _upedgelimit;
+  long _memlimit;
+};
 
 // \todo _fix_me_
 #if 0
@@ -1272,6 +1478,10 @@ class item_owner
     tItem::reset_ids();
   }
   void add(tItem *it) { _list.push_back(it); }
+  /** The arena of the items of this owner and of their hypotheses. It is
+   *  released as a whole when the owner (i.e., the chart) is destroyed.
+   */
+  pool_allocator &pool() { return _pool; }
   void print(std::ostream &stream) {
     for(item_iter it = _list.begin(); it != _list.end(); ++it)
       if(!(*it)->frozen()) {
@@ -1279,6 +1489,8 @@ class item_owner
       } // if
   } // print()
  private:
+  // declared first, so that it is destroyed last
+  pool_allocator _pool;
   item_list _list;
 };
 
@@ -46,6 +46,8 @@ void usage(FILE *f)
 #endif
   fprintf(f, "  `-nsolutions[=n]' --- find best n only, 1 if n is not given\n");
   fprintf(f, "  `-sm[=string]' --- parse selection model (`null' for none)\n");
+  fprintf(f, "  `-compile-sm=file' --- write the parse selection model in "
+             "binary form to file\n");
   fprintf(f, "  `-verbose[=n]' --- set verbosity level to n\n");
   fprintf(f, "  `-limit=n' --- maximum number of passive edges\n");
   fprintf(f, "  `-memlimit=n' --- maximum amount of fs memory (in MB)\n");
@@ -54,6 +56,17 @@ void usage(FILE *f)
   fprintf(f, "  `-no-filter' --- disable rule filter\n");
   fprintf(f, "  `-qc-unif=n' --- use only top n quickcheck paths (unification)\n");
   fprintf(f, "  `-qc-subs=n' --- use only top n quickcheck paths (subsumption)\n");
+  fprintf(f, "  `-qc-adapt[=file]' --- reorder quickcheck paths (unification) by\n"
+             "                           observed failures, keep the order in file\n");
+  fprintf(f, "  `-qc-order=file' --- read the quickcheck path order from file\n");
+  fprintf(f, "  `-qc-rule-slots=file' --- read rule specific quickcheck paths "
+             "(unification) from file\n");
+  fprintf(f, "  `-compute-qc-rule-slots=file' --- compute rule specific "
+             "quickcheck paths\n"
+             "                           (unification), output to file\n");
+  fprintf(f, "  `-check-qc-subs' --- report where the subsumption quickcheck "
+             "disagrees\n"
+             "                           with full subsumption while packing\n");
   fprintf(f, "  `-compute-qc[=file]' --- compute quickcheck paths (output to file,\n"
              "                           default /tmp/qc.tdl)\n");
   fprintf(f, "  `-compute-qc-unif[=file]' --- compute quickcheck paths only for unificaton (output to file,\n"
@@ -72,10 +85,22 @@ void usage(FILE *f)
   fprintf(f, "  `-predict-les' --- enable use of type predictor for lexical gaps\n");
   fprintf(f, "  `-lattice' --- word lattice parsing\n");
   fprintf(f, "  `-server[=n]' --- go into server mode, bind to port `n' (default: 4711)\n");
+#ifdef HAVE_XMLRPC_C
+  fprintf(f, "  `-server-workers=n' --- "
+          "parse in `n' worker processes (XML-RPC server)\n");
+  fprintf(f, "  `-server-queue=n' --- "
+          "accept at most `n' pending requests (XML-RPC server, default: 16)\n");
+#endif
 #ifdef YY
   fprintf(f, "  `-one-meaning[=n]' --- non exhaustive search for first [nth]\n"
              "                         valid semantic formula\n");
   fprintf(f, "  `-yy' --- enable YY input mode\n");
+  fprintf(f, "  `-server-prefork=n' --- "
+          "serve clients from `n' pre-forked children (socket server)\n");
+  fprintf(f, "  `-server-recycle=n[,m]' --- "
+          "replace a pre-forked child after `n' items or `m' MB growth\n");
+  fprintf(f, "  `-server-warmup=file' --- "
+          "parse the sentences in `file' before forking the children\n");
 #endif
   fprintf(f, "  `-repp[=file]' --- use REPP to tokenize, with settings in file\n");
   fprintf(f, "  `-tagger[=file]' --- POS tag input, using settings in file\n");
@@ -103,6 +128,10 @@ void usage(FILE *f)
           "enable chart mapping (token mapping and lexical filtering)\n");
   fprintf(f, "  `-cp=[strategy]limit' --- "
           "enable chart pruning. Strategy can be (a)ll, (s)uccessful and (p)assive (default).\n");
+  fprintf(f, "  `-wavefront' --- "
+          "build items in order of increasing span length\n");
+  fprintf(f, "  `-fail-cache=n' --- "
+          "remember up to `n' failed rule applications (default: 0)\n");
   fprintf(f, "  `-inputfile=file' --- "
           "name of input file to read from instead of standard input\n");
   fprintf(f, "  `-ut[=file]' --- request ubertagging, with settings in file\n");
@@ -156,10 +185,23 @@ void usage(FILE *f)
 #define OPTION_PREPROCESS_ONLY 47
 #define OPTION_UT 48
 #define OPTION_LP_THRESHOLD 49
+#define OPTION_SERVER_WORKERS 50
+#define OPTION_SERVER_QUEUE 51
+#define OPTION_WAVEFRONT 52
+#define OPTION_FAIL_CACHE 53
+#define OPTION_QC_ADAPT 54
+#define OPTION_QC_ORDER 55
+#define OPTION_QC_RULE_SLOTS 56
+#define OPTION_COMPUTE_QC_RULE_SLOTS 57
+#define OPTION_CHECK_QC_SUBS 58
+#define OPTION_COMPILE_SM 59
 
 #ifdef YY
 #define OPTION_ONE_MEANING 100
 #define OPTION_YY 101
+#define OPTION_SERVER_PREFORK 102
+#define OPTION_SERVER_RECYCLE 103
+#define OPTION_SERVER_WARMUP 104
 #endif
 
 //typedef T (*fromfunc)(const std::string &s);
@@ -197,6 +239,9 @@ char* parse_options(int argc, char* argv[])
 #ifdef YY
     {"yy", no_argument, 0, OPTION_YY},
     {"one-meaning", optional_argument, 0, OPTION_ONE_MEANING},
+    {"server-prefork", required_argument, 0, OPTION_SERVER_PREFORK},
+    {"server-recycle", required_argument, 0, OPTION_SERVER_RECYCLE},
+    {"server-warmup", required_argument, 0, OPTION_SERVER_WARMUP},
 #endif
     {"server", optional_argument, 0, OPTION_SERVER},
     {"log", required_argument, 0, OPTION_LOG},
@@ -223,6 +268,17 @@ char* parse_options(int argc, char* argv[])
     {"take", optional_argument, 0, OPTION_TAKE},
     {"ut", optional_argument, 0, OPTION_UT},
     {"lpthreshold", required_argument, 0, OPTION_LP_THRESHOLD},
+    {"server-workers", required_argument, 0, OPTION_SERVER_WORKERS},
+    {"server-queue", required_argument, 0, OPTION_SERVER_QUEUE},
+    {"wavefront", no_argument, 0, OPTION_WAVEFRONT},
+    {"fail-cache", required_argument, 0, OPTION_FAIL_CACHE},
+    {"qc-adapt", optional_argument, 0, OPTION_QC_ADAPT},
+    {"qc-order", required_argument, 0, OPTION_QC_ORDER},
+    {"qc-rule-slots", required_argument, 0, OPTION_QC_RULE_SLOTS},
+    {"compute-qc-rule-slots", required_argument, 0,
+     OPTION_COMPUTE_QC_RULE_SLOTS},
+    {"check-qc-subs", no_argument, 0, OPTION_CHECK_QC_SUBS},
+    {"compile-sm", required_argument, 0, OPTION_COMPILE_SM},
     {0, 0, 0, 0}
   }; /* struct option */
 
@@ -492,6 +548,41 @@ char* parse_options(int argc, char* argv[])
         if(optarg != NULL)
           set_opt("opt_lpthreshold", strtod(optarg, NULL));
         break;
+      case OPTION_SERVER_WORKERS:
+          set_opt("opt_server_workers",
+                  strtoint(optarg, "as argument to -server-workers"));
+          break;
+      case OPTION_SERVER_QUEUE:
+          set_opt("opt_server_queue",
+                  strtoint(optarg, "as argument to -server-queue"));
+          break;
+      case OPTION_WAVEFRONT:
+          set_opt("opt_wavefront", true);
+          break;
+      case OPTION_FAIL_CACHE:
+          set_opt("opt_fail_cache",
+                  strtoint(optarg, "as argument to -fail-cache"));
+          break;
+      case OPTION_QC_ADAPT:
+          set_opt("opt_qc_adapt", true);
+          if(optarg != NULL)
+            set_opt("opt_qc_order", std::string(optarg));
+          break;
+      case OPTION_QC_ORDER:
+          set_opt("opt_qc_order", std::string(optarg));
+          break;
+      case OPTION_QC_RULE_SLOTS:
+          set_opt("opt_qc_rule_slots", std::string(optarg));
+          break;
+      case OPTION_COMPUTE_QC_RULE_SLOTS:
+          set_opt("opt_compute_qc_rule_slots", std::string(optarg));
+          break;
+      case OPTION_CHECK_QC_SUBS:
+          set_opt("opt_check_qc_subs", true);
+          break;
+      case OPTION_COMPILE_SM:
+          set_opt("opt_compile_sm", std::string(optarg));
+          break;
 #ifdef YY
       case OPTION_ONE_MEANING:
           if(optarg != NULL)
@@ -503,6 +594,24 @@ char* parse_options(int argc, char* argv[])
           set_opt("opt_yy", true);
           set_opt_from_string("opt_tok", "yy");
           break;
+      case OPTION_SERVER_PREFORK:
+          set_opt("opt_server_prefork",
+                  strtoint(optarg, "as argument to -server-prefork"));
+          break;
+      case OPTION_SERVER_RECYCLE: {
+          char *mem = strchr(optarg, ',');
+          if(mem != NULL) {
+            *mem++ = '\0';
+            set_opt("opt_server_recycle_mem",
+                    strtoint(mem, "as argument to -server-recycle"));
+          }
+          set_opt("opt_server_recycle",
+                  strtoint(optarg, "as argument to -server-recycle"));
+          break;
+      }
+      case OPTION_SERVER_WARMUP:
+          set_opt("opt_server_warmup", std::string(optarg));
+          break;
 #endif
       }
     }
@@ -61,7 +61,7 @@ timer TotalParseTime(false);
 static bool parser_init();
 //options managed by configuration subsystem
 bool opt_hyper = parser_init();
-int  opt_nsolutions, opt_packing;
+int  opt_nsolutions, opt_packing, opt_fail_cache;
 
 #ifdef YY
 int opt_nth_meaning;
@@ -82,6 +82,10 @@ static bool parser_init() {
                 "2:proactive 4:retroactive packing; "
                 "8:selective 128:no unpacking", opt_packing);
   opt_packing = 0;
+  reference_opt("opt_fail_cache",
+                "maximum number of failed rule applications to remember "
+                "across items (0: don't cache failures)", opt_fail_cache);
+  opt_fail_cache = 0;
   managed_opt("opt_pedgelimit", "maximum number of passive edges",
               (int) 0);
   managed_opt("opt_memlimit", "memory limit (in MB) for parsing and unpacking",
@@ -90,6 +94,12 @@ static bool parser_init() {
               (int) 0);
   managed_opt("opt_shrink_mem", "allow process to shrink after huge items",
               true);
+  managed_opt("opt_wavefront",
+              "process the agenda in order of increasing span length "
+              "(CKY-style wavefronts)", false);
+  managed_opt("opt_check_qc_subs",
+              "run the full subsumption test also where the subsumption "
+              "quickcheck fails, and report where they disagree", false);
   return opt_hyper;
 }
 
@@ -108,82 +118,119 @@ clock_t timestamp;
 //@}
 
 //
-// filtering
+// parse contexts
 //
 
-bool
-filter_rule_task(grammar_rule *R, tItem *passive)
+tParseContext::tParseContext()
+  : _chart(NULL), _agenda(NULL), _t_alloc(CHUNK_SIZE, false),
+    _unify_generation(0), _timeout(0), _timestamp(0),
+    _default_owner(NULL), _next_item_id(1), _active(false)
 {
+  _stats.reset();
+}
 
-#ifdef PETDEBUG
-    LOG(logParse, DEBUG, "trying " << R << " & passive " << passive << " ==> ");
-#endif
-
-    if(!Grammar->filter_compatible(R, R->nextarg(), passive->rule()))
-    {
-        stats.ftasks_fi++;
-
-#ifdef PETDEBUG
-        LOG(logParse, DEBUG, "filtered (rf)");
-#endif
-
-        return false;
-    }
-
-    if(!fs::qc_compatible_unif(R->qc_vector_unif(R->nextarg()),
-                               passive->qc_vector_unif()))
-    {
-        stats.ftasks_qc++;
-
-#ifdef PETDEBUG
-        LOG(logParse, DEBUG, "filtered (qc)");
-#endif
-
-        return false;
-    }
+tParseContext::~tParseContext()
+{
+  if(_active)
+    deactivate();
+  // the chart is handed out to the caller of analyze(), who deletes it
+  delete _agenda;
+}
 
-#ifdef PETDEBUG
-    LOG(logParse, DEBUG, "passed filters");
+void
+tParseContext::swap_state()
+{
+  std::swap(Chart, _chart);
+  std::swap(Agenda, _agenda);
+  std::swap(stats, _stats);
+  t_alloc.swap(_t_alloc);
+#ifdef DAG_TOMABECHI
+  std::swap(unify_generation, _unify_generation);
 #endif
-
-    return true;
+  std::swap(timeout, _timeout);
+  std::swap(timestamp, _timestamp);
+  tPathTable::swap(_paths);
+  item_owner *owner = tItem::default_owner();
+  tItem::default_owner(_default_owner);
+  _default_owner = owner;
+  int id = tItem::next_id();
+  tItem::next_id(_next_item_id);
+  _next_item_id = id;
 }
 
-bool
-filter_combine_task(tItem *active, tItem *passive)
+void
+tParseContext::activate()
 {
-#ifdef PETDEBUG
-    LOG(logParse, DEBUG, "trying active " << *active
-        << " & passive " << *passive << " ==> ");
-#endif
+  if(_active)
+    throw tError("parse context is already active");
+  swap_state();
+  _active = true;
+}
 
-    if(!Grammar->filter_compatible(active->rule(), active->nextarg(),
-                                   passive->rule()))
-    {
-#ifdef PETDEBUG
-        LOG(logParse, DEBUG, "filtered (rf)");
-#endif
+void
+tParseContext::deactivate()
+{
+  if(! _active)
+    throw tError("parse context is not active");
+  swap_state();
+  _active = false;
+}
 
-        stats.ftasks_fi++;
-        return false;
-    }
+//
+// filtering
+//
 
-    if(!fs::qc_compatible_unif(active->qc_vector_unif(),
-                               passive->qc_vector_unif()))
-    {
-#ifdef PETDEBUG
-        LOG(logParse, DEBUG, "filtered (qc)");
-#endif
+/** Candidates of the current postulate() or fundamental_for_*() call that
+ *  passed the rule filter, with their quick check vectors. The quick check
+ *  is then run over all of them in one call to fs::qc_filter_unif().
+ */
+static vector<tItem *> qc_items;
+static vector<grammar_rule *> qc_rules;
+static vector<qc_vec> qc_vectors;
+/** The rule and argument position every candidate is tested for */
+static vector<pair<grammar_rule *, int> > qc_args;
+static vector<char> qc_ok;
+
+/** Run the batched quick check of \a qc against the collected candidates,
+ *  and count the failures in the statistics.
+ *
+ * If rule specific quick check slots are used (or computed), the candidates
+ * are checked one by one on the slots of their rule argument instead.
+ */
+static void
+filter_qc_batch(const qc_vec &qc)
+{
+  int n = qc_vectors.size();
+  qc_ok.assign(n, 1);
+  if(n == 0 || fs::get_unif_qc_length() == 0) return;
+
+  bool rule_specific = false;
+  for(int j = 0; j < n && !rule_specific; ++j) {
+    grammar_rule *R = qc_args[j].first;
+    int arg = qc_args[j].second;
+    rule_specific = (R->qc_slots_unif(arg) != NULL
+                     || R->qc_rejects_unif(arg) != NULL);
+  }
 
-        stats.ftasks_qc++;
-        return false;
+  int passed = 0;
+  if(rule_specific) {
+    for(int j = 0; j < n; ++j) {
+      grammar_rule *R = qc_args[j].first;
+      int arg = qc_args[j].second;
+      unsigned int *rejects = R->qc_rejects_unif(arg);
+      const vector<int> *slots = R->qc_slots_unif(arg);
+      if(rejects != NULL)
+        qc_ok[j] = fs::qc_record_unif(qc, qc_vectors[j], rejects);
+      else if(slots != NULL)
+        qc_ok[j] = fs::qc_compatible_unif(qc, qc_vectors[j], *slots);
+      else
+        qc_ok[j] = fs::qc_compatible_unif(qc, qc_vectors[j]);
+      if(qc_ok[j]) ++passed;
     }
-
-#ifdef PETDEBUG
-    LOG(logParse, DEBUG, "passed filters");
-#endif
-
-    return true;
+  }
+  else
+    passed = fs::qc_filter_unif(qc, &qc_vectors[0], n, &qc_ok[0]);
+  stats.ftasks_qc += n - passed;
 }
 
 //
@@ -196,161 +243,290 @@ filter_combine_task(tItem *active, tItem *passive)
 void
 postulate(tItem *passive) {
   assert(!passive->blocked());
+  qc_rules.clear();
+  qc_vectors.clear();
+  qc_args.clear();
   // iterate over all the rules in the grammar
   for(ruleiter rule = Grammar->rules().begin(); rule != Grammar->rules().end();
       ++rule) {
     grammar_rule *R = *rule;
 
-    if(passive->compatible(R, Chart->rightmost()))
-      if(filter_rule_task(R, passive))
-        Agenda->push(new rule_and_passive_task(Chart, Agenda, R, passive));
+    if(passive->compatible(R, Chart->rightmost())) {
+      if(!Grammar->filter_compatible(R, R->nextarg(), passive->rule())) {
+        stats.ftasks_fi++;
+#ifdef PETDEBUG
+        LOG(logParse, DEBUG, "trying " << R << " & passive " << passive
+            << " ==> filtered (rf)");
+#endif
+        continue;
+      }
+      qc_rules.push_back(R);
+      qc_vectors.push_back(R->qc_vector_unif(R->nextarg()));
+      qc_args.push_back(make_pair(R, R->nextarg()));
+    }
   }
+
+  filter_qc_batch(passive->qc_vector_unif());
+  for(size_t i = 0; i < qc_rules.size(); ++i)
+    if(qc_ok[i])
+      Agenda->push(new rule_and_passive_task(Chart, Agenda, qc_rules[i],
+                                             passive));
 }
 
 void
 fundamental_for_passive(tItem *passive)
 {
+    qc_items.clear();
+    qc_vectors.clear();
+    qc_args.clear();
     // iterate over all active items adjacent to passive and try combination
     for(chart_iter_adj_active it(Chart, passive); it.valid(); ++it)
     {
         tItem *active = it.current();
-        if(active->adjacent(passive))
-            if(passive->compatible(active, Chart->rightmost()))
-                if(filter_combine_task(active, passive))
-                    Agenda->push(new active_and_passive_task(Chart, Agenda,
-                                                             active, passive));
+        if(active->adjacent(passive)
+           && passive->compatible(active, Chart->rightmost()))
+        {
+            if(!Grammar->filter_compatible(active->rule(), active->nextarg(),
+                                           passive->rule()))
+            {
+                stats.ftasks_fi++;
+                continue;
+            }
+            qc_items.push_back(active);
+            qc_vectors.push_back(active->qc_vector_unif());
+            qc_args.push_back(make_pair(active->rule(), active->nextarg()));
+        }
     }
+
+    filter_qc_batch(passive->qc_vector_unif());
+    for(size_t i = 0; i < qc_items.size(); ++i)
+        if(qc_ok[i])
+            Agenda->push(new active_and_passive_task(Chart, Agenda,
+                                                     qc_items[i], passive));
 }
 
 void
 fundamental_for_active(tPhrasalItem *active) {
+  qc_items.clear();
+  qc_vectors.clear();
+  qc_args.clear();
   // iterate over all passive items adjacent to active and try combination
+  for(chart_iter_adj_passive it(Chart, active); it.valid(); ++it) {
+    tItem *passive = it.current();
+    if(!passive->blocked()
+       && passive->compatible(active, Chart->rightmost())) {
+      if(!Grammar->filter_compatible(active->rule(), active->nextarg(),
+                                     passive->rule())) {
+        stats.ftasks_fi++;
+        continue;
+      }
+      qc_items.push_back(passive);
+      qc_vectors.push_back(passive->qc_vector_unif());
+      qc_args.push_back(make_pair(active->rule(), active->nextarg()));
+    }
+  }
 
-  for(chart_iter_adj_passive it(Chart, active); it.valid(); ++it)
-    if(!it.current()->blocked())
-      if(it.current()->compatible(active, Chart->rightmost()))
-        if(filter_combine_task(active, it.current()))
-          Agenda->push(new
-                       active_and_passive_task(Chart, Agenda,
-                                               active, it.current()));
+  filter_qc_batch(active->qc_vector_unif());
+  for(size_t i = 0; i < qc_items.size(); ++i)
+    if(qc_ok[i])
+      Agenda->push(new active_and_passive_task(Chart, Agenda,
+                                               active, qc_items[i]));
 }
 
+/** Value of opt_check_qc_subs for the current parse, read once in analyze()
+ *  rather than for every new passive item.
+ */
+static bool check_qc_subs = false;
+
+/** Result of the full subsumption test of an item found by the fingerprint
+ *  probe in packed_edge(), so that the bucket scan need not repeat it.
+ */
+struct packing_probe {
+  tItem *item;
+  bool forward, backward;
+  packing_probe(tItem *it, bool f, bool b)
+    : item(it), forward(f), backward(b) {}
+};
+static vector<packing_probe> packing_probes;
+
 bool
 packed_edge(tItem *newitem) {
   if(!newitem->inflrs_complete_p() || !newitem->prefix_lrs_complete_p()) 
     return false;
 
-  for(chart_iter_span_passive iter(Chart, newitem->start(), newitem->end());
-      iter.valid(); ++iter) {
-    bool forward, backward;
-    tItem *olditem = iter.current();
+  // An equivalent item (almost always) has the same fingerprint, so look it
+  // up in the packing index first. Non-equivalent results are kept for the
+  // bucket scan below.
+  packing_probes.clear();
+  const item_list *equivalents;
+  if((opt_packing & PACKING_EQUI)
+     && (equivalents = Chart->packing_candidates(newitem)) != NULL) {
+    for(item_list::const_iterator it = equivalents->begin();
+        it != equivalents->end(); ++it) {
+      tItem *olditem = *it;
+      if(olditem->blocked()
+         || !olditem->inflrs_complete_p() || !olditem->prefix_lrs_complete_p()
+         || (olditem->trait() == INPUT_TRAIT)
+         || newitem->contains_p(olditem))
+        continue;
+
+      bool forward = true, backward = true;
+      subsumes(olditem->get_fs(), newitem->get_fs(), forward, backward);
+      if(forward && backward) {
+        LOG(logPack, DEBUG, "proactive (equi) packing:" << endl
+            << *newitem << endl << " --> " << endl << *olditem << endl);
+        stats.p_equivalent++;
+        olditem->packed.push_back(newitem);
+        return true;
+      }
+      packing_probes.push_back(packing_probe(olditem, forward, backward));
+    }
+  }
 
-    if(!olditem->inflrs_complete_p() || !olditem->prefix_lrs_complete_p()
-       || (olditem->trait() == INPUT_TRAIT))
-      continue;
+  type_t newtype = newitem->get_fs().type();
+  grammar_rule *newrule = newitem->rule();
 
-    // YZ 2007-07-25: avoid packing item with its offspring edges
-    // (both forward and backward)
-    if (newitem->contains_p(olditem))
+  // The items of the span are bucketed by root type and rule, and both the
+  // subsumption filter and the root type test are answered once per bucket,
+  // so only the items of compatible buckets are looked at one by one.
+  const chart::packing_bucket_vector &buckets
+    = Chart->packing_buckets(newitem->start(), newitem->end());
+  for(chart::packing_bucket_vector::const_iterator bucket = buckets.begin();
+      bucket != buckets.end(); ++bucket) {
+    // sets forward and backward correctly in every case
+    bool bucket_forward, bucket_backward;
+    Grammar->subsumption_filter_compatible(bucket->rule, newrule,
+                                           bucket_forward, bucket_backward);
+
+    // subsumption in either direction requires the root types to be in the
+    // same relation
+    if((bucket_forward || bucket_backward) && bucket->type != newtype) {
+      bool st_old_new, st_new_old;
+      subtype_bidir(bucket->type, newtype, st_old_new, st_new_old);
+      if(!st_old_new) bucket_backward = false;
+      if(!st_new_old) bucket_forward = false;
+    }
+
+    if(bucket_forward == false && bucket_backward == false) {
+      stats.fsubs_fi += bucket->items.size();
       continue;
+    }
 
-    // sets forward and backward correctly in every case
-    Grammar->subsumption_filter_compatible(olditem->rule(), newitem->rule(),
-                                           forward, backward);
+    for(chart_item_vector::const_iterator iter = bucket->items.begin();
+        iter != bucket->items.end(); ++iter) {
+      tItem *olditem = *iter;
 
-#ifdef PETDEBUG_SUBSFAILS
-    failure *uf = NULL;
-#endif
+      if(!olditem->inflrs_complete_p() || !olditem->prefix_lrs_complete_p()
+         || (olditem->trait() == INPUT_TRAIT))
+        continue;
 
-    if(forward ==false && backward == false) {
-      stats.fsubs_fi++;
-    }
-    else {
-      bool f1 = true, b1 = true;
-      fs::qc_compatible_subs(olditem->qc_vector_subs(),
-                             newitem->qc_vector_subs(),
-                             f1, b1);
+      // YZ 2007-07-25: avoid packing item with its offspring edges
+      // (both forward and backward)
+      if (newitem->contains_p(olditem))
+        continue;
+
+      bool forward = bucket_forward, backward = bucket_backward;
 
 #ifdef PETDEBUG_SUBSFAILS
-      start_recording_failures();
+      failure *uf = NULL;
 #endif
 
-      if(forward ==false && backward == false)
-        stats.fsubs_qc++;
-      else
-        subsumes(olditem->get_fs(), newitem->get_fs(),
-                 forward, backward);
+      vector<packing_probe>::const_iterator probe = packing_probes.begin();
+      while(probe != packing_probes.end() && probe->item != olditem)
+        ++probe;
+
+      if(probe != packing_probes.end()) {
+        // already tested by the fingerprint probe
+        forward = probe->forward;
+        backward = probe->backward;
+      }
+      else {
+        bool f1 = forward, b1 = backward;
+        fs::qc_compatible_subs(olditem->qc_vector_subs(),
+                               newitem->qc_vector_subs(),
+                               f1, b1);
 
 #ifdef PETDEBUG_SUBSFAILS
-      uf = stop_recording_failures();
+        start_recording_failures();
 #endif
 
-#if 0
-      //
-      // according to ulrich (sometime mid-2004), we sometimes hit this
-      // condition (for the ERG), hence subsumption quick check remains
-      // off for the time being.                         (11-jan-05; oe)
-      //
-      if(f1 == false && forward || b1==false && backward)
-        {
-          fprintf(stderr, "S | > %c vs %c | < %c vs %c\n",
-                  f1 ? 't' : 'f',
-                  forward ? 't' : 'f',
-                  b1 ? 't' : 'f',
-                  backward ? 't' : 'f');
+        if(check_qc_subs) {
+          // validation mode: ignore the quick check, but report every case
+          // where it would have ruled out a subsumption that actually holds
+          subsumes(olditem->get_fs(), newitem->get_fs(), forward, backward);
+          if((forward && !f1) || (backward && !b1))
+            LOG(logPack, WARN, "subsumption quickcheck mismatch for "
+                << olditem->id() << " vs " << newitem->id()
+                << ": forward " << f1 << "/" << forward
+                << ", backward " << b1 << "/" << backward);
+        }
+        else {
+          forward = f1;
+          backward = b1;
+          if(forward == false && backward == false)
+            stats.fsubs_qc++;
+          else
+            subsumes(olditem->get_fs(), newitem->get_fs(),
+                     forward, backward);
         }
-#endif
-    }
 
 #ifdef PETDEBUG_SUBSFAILS
-    if ((! ((forward && !olditem->blocked()) &&
-            ((!backward && (opt_packing & PACKING_PRO))
-             || (backward && (opt_packing & PACKING_EQUI)))))
-        &&
-        (! (backward && (opt_packing & PACKING_RETRO) && !olditem->frosted())))
-      {
-        const char *id1 = (newitem->rule() != NULL)
-          ? newitem->rule()->printname() : newitem->printname() ;
-        const char *id2 = (olditem->rule() != NULL)
-          ? olditem->rule()->printname() : olditem->printname() ;
-        if (uf != NULL)
-          LOG(logParse, DEBUG, "SF: " << id1 << " <-> " << id2 << " " << *uf);
-        else
-          LOG(logParse, DEBUG, "SF: " << id1 << " <-> " << id2);
+        uf = stop_recording_failures();
+#endif
       }
+
+#ifdef PETDEBUG_SUBSFAILS
+      if ((! ((forward && !olditem->blocked()) &&
+              ((!backward && (opt_packing & PACKING_PRO))
+               || (backward && (opt_packing & PACKING_EQUI)))))
+          &&
+          (! (backward && (opt_packing & PACKING_RETRO)
+              && !olditem->frosted())))
+        {
+          const char *id1 = (newitem->rule() != NULL)
+            ? newitem->rule()->printname() : newitem->printname() ;
+          const char *id2 = (olditem->rule() != NULL)
+            ? olditem->rule()->printname() : olditem->printname() ;
+          if (uf != NULL)
+            LOG(logParse, DEBUG, "SF: " << id1 << " <-> " << id2 << " "
+                << *uf);
+          else
+            LOG(logParse, DEBUG, "SF: " << id1 << " <-> " << id2);
+        }
 #endif
 
-    if(forward && !olditem->blocked()) {
-      if((!backward && (opt_packing & PACKING_PRO))
-         || (backward && (opt_packing & PACKING_EQUI))) {
-        LOG(logPack, DEBUG, "proactive (" << (backward ? "equi" : "subs")
-            << ") packing:" << endl << *newitem << endl
-            << " --> " << endl << *olditem << endl);
+      if(forward && !olditem->blocked()) {
+        if((!backward && (opt_packing & PACKING_PRO))
+           || (backward && (opt_packing & PACKING_EQUI))) {
+          LOG(logPack, DEBUG, "proactive (" << (backward ? "equi" : "subs")
+              << ") packing:" << endl << *newitem << endl
+              << " --> " << endl << *olditem << endl);
 
-        if(backward)
-          stats.p_equivalent++;
-        else
-          stats.p_proactive++;
+          if(backward)
+            stats.p_equivalent++;
+          else
+            stats.p_proactive++;
 
-        olditem->packed.push_back(newitem);
-        return true;
+          olditem->packed.push_back(newitem);
+          return true;
+        }
       }
-    }
 
-    if(backward && (opt_packing & PACKING_RETRO) && !olditem->frosted()) {
-      LOG(logPack, DEBUG,  "retroactive packing:" << endl
-          << *newitem << " <- " << *olditem << endl);
+      if(backward && (opt_packing & PACKING_RETRO) && !olditem->frosted()) {
+        LOG(logPack, DEBUG,  "retroactive packing:" << endl
+            << *newitem << " <- " << *olditem << endl);
 
-      newitem->packed.splice(newitem->packed.begin(), olditem->packed);
+        newitem->packed.splice(newitem->packed.begin(), olditem->packed);
 
-      if(!olditem->blocked()) {
-        stats.p_retroactive++;
-        newitem->packed.push_back(olditem);
-      }
+        if(!olditem->blocked()) {
+          stats.p_retroactive++;
+          newitem->packed.push_back(olditem);
+        }
 
-      olditem->frost();
+        olditem->frost();
 
-      // delete (old, chart)
+        // delete (old, chart)
+      }
     }
   }
   return false;
@@ -390,6 +566,8 @@ bool add_item(tItem *it) {
       return false;
 
     Chart->add(it);
+    if(opt_packing)
+      Chart->add_packing_index(it);
 
     type_t rule;
     if(it->root(Grammar, Chart->rightmost(), rule)) {
@@ -508,11 +686,14 @@ parse_loop(fs_alloc_state &FSAS, list<tError> &errors, clock_t timeout) {
 
 /**
  * Unpacks the parse forest selectively (using the max-ent model).
+ * If \a lazy is \c true, only the best reading is unpacked and the unpacker
+ * is kept in the chart for unpack_readings().
  * \return number of unpacked trees
  */
 int unpack_selectively(std::vector<tItem*> &trees, int upedgelimit,
                        long memlimit, int nsolutions,
-                       timer *UnpackTime , vector<tItem *> &readings) {
+                       timer *UnpackTime , vector<tItem *> &readings,
+                       bool lazy) {
   int nres = 0;
   if (memlimit > 0 && (p_alloc.max_usage_mb() + t_alloc.max_usage_mb()) >= memlimit)
     //
@@ -540,9 +721,20 @@ int unpack_selectively(std::vector<tItem*> &trees, int upedgelimit,
       uroots.push_back(*tree);
     }
   }
-  list<tItem*> results
-    = tItem::selectively_unpack(uroots, nsolutions
-                                , Chart->rightmost(), upedgelimit, memlimit);
+  tSelectiveUnpacker *unpacker
+    = new tSelectiveUnpacker(uroots, Chart->rightmost(), upedgelimit,
+                             memlimit);
+  list<tItem*> results;
+  try {
+    results = unpacker->next(lazy ? 1 : nsolutions);
+  } catch(tError) {
+    delete unpacker;
+    throw;
+  }
+  if (lazy && nsolutions > 1 && !unpacker->exhausted())
+    Chart->unpacker(unpacker);
+  else
+    delete unpacker;
 
   static tCompactDerivationPrinter cdp;
   for (list<tItem*>::iterator res = results.begin();
@@ -607,7 +799,7 @@ int unpack_exhaustively(vector<tItem*> &trees, int upedgelimit,
 vector<tItem*>
 collect_readings(fs_alloc_state &FSAS, list<tError> &errors,
                  int pedgelimit, long memlimit, int nsolutions,
-                 vector<tItem*> &trees) {
+                 vector<tItem*> &trees, bool lazy) {
   vector<tItem *> readings;
 
   if(opt_packing && !(opt_packing & PACKING_NOUNPACK)) {
@@ -624,7 +816,7 @@ collect_readings(fs_alloc_state &FSAS, list<tError> &errors,
           && Grammar->sm()) {
         try {
           unpack_selectively(trees, upedgelimit, memlimit, nsolutions,
-                             UnpackTime, readings);
+                             UnpackTime, readings, lazy);
         } catch(tError e) {
           errors.push_back(e);
         }
@@ -670,7 +862,8 @@ collect_readings(fs_alloc_state &FSAS, list<tError> &errors,
 
 
 void
-parse_finish(fs_alloc_state &FSAS, list<tError> &errors, clock_t timeout) {
+parse_finish(fs_alloc_state &FSAS, list<tError> &errors, clock_t timeout,
+             bool lazy) {
   long memlimit = get_opt_int("opt_memlimit");
   int pedgelimit = get_opt_int("opt_pedgelimit");
   clock_t timestamp = (timeout > 0 ? times(NULL) : 0);
@@ -720,10 +913,12 @@ parse_finish(fs_alloc_state &FSAS, list<tError> &errors, clock_t timeout) {
   else
     Chart->readings() 
       = collect_readings(FSAS, errors, pedgelimit, memlimit, 
-                         opt_nsolutions, Chart->trees());
+                         opt_nsolutions, Chart->trees(), lazy);
 
   stats.readings = Chart->readings().size();
 
+  // let the quick check learn from this parse
+  fs::qc_adapt_order_unif();
 }
 
 
@@ -731,7 +926,7 @@ parse_finish(fs_alloc_state &FSAS, list<tError> &errors, clock_t timeout) {
 
 void
 analyze(string input, chart *&C, fs_alloc_state &FSAS
-        , list<tError> &errors, int id)
+        , list<tError> &errors, int id, bool lazy)
 {
   // optionally clearing memory before rather than after analyzing since
   // we want to allow for lazy output of parse results in a server mode
@@ -743,10 +938,12 @@ analyze(string input, chart *&C, fs_alloc_state &FSAS
   FSAS.clear_stats();
   stats.reset();
   stats.id = id;
+  check_qc_subs = get_opt_bool("opt_check_qc_subs");
 
   Chart = C;
   auto_ptr<item_owner> owner(new item_owner);
   tItem::default_owner(owner.get());
+  tPathTable::clear();
 
   unify_wellformed = true;
 
@@ -775,7 +972,12 @@ analyze(string input, chart *&C, fs_alloc_state &FSAS
   } // catch
 
   if (get_opt_int("opt_chart_pruning") != 0) {
+    if (get_opt_bool("opt_wavefront"))
+      LOG(logParse, WARN, "ignoring -wavefront, chart pruning uses its own "
+          "agenda");
     Agenda = new tLocalCapAgenda (get_opt_int ("opt_chart_pruning"), max_pos);
+  } else if (get_opt_bool("opt_wavefront")) {
+    Agenda = new tWavefrontAgenda;
   } else {
     Agenda = new tExhaustiveAgenda;
   }
@@ -796,7 +998,7 @@ analyze(string input, chart *&C, fs_alloc_state &FSAS
   ParseTime.stop();
   TotalParseTime.stop();
 
-  parse_finish(FSAS, errors, timeout);
+  parse_finish(FSAS, errors, timeout, lazy);
 
   if(get_opt_int("opt_robust") != 0 && (Chart->readings().empty()))
     analyze_pcfg(Chart, FSAS, errors);
@@ -808,4 +1010,45 @@ analyze(string input, chart *&C, fs_alloc_state &FSAS
   if(input_items.size()) Lexparser.reset();
   // clear_dynamic_types(); // too early
   delete Agenda;
+  Agenda = NULL;
+}
+
+int
+unpack_readings(size_t n, list<tError> &errors)
+{
+  vector<tItem *> &readings = Chart->readings();
+  if (n > (size_t) opt_nsolutions) n = opt_nsolutions;
+  if (Chart->unpacker() == NULL || readings.size() >= n) return 0;
+
+  // the readings on demand get the full time again, not what was left over
+  // after parsing
+  if (get_opt_int("opt_timeout") > 0) {
+    timestamp = times(NULL);
+    timeout = timestamp + (clock_t)get_opt_int("opt_timeout");
+  }
+
+  size_t before = readings.size();
+  try {
+    list<tItem *> results = Chart->unpacker()->next(n - before);
+    readings.insert(readings.end(), results.begin(), results.end());
+  } catch(tError e) {
+    errors.push_back(e);
+    Chart->unpacker(NULL);
+  }
+
+  int pedgelimit = get_opt_int("opt_pedgelimit");
+  int upedgelimit = pedgelimit ? pedgelimit - Chart->pedges() : 0;
+  if (upedgelimit > 0 && stats.p_upedges > upedgelimit) {
+    ostringstream s;
+    s << "unpack edge limit exhausted (" << upedgelimit << " pedges)";
+    errors.push_back(s.str());
+  }
+
+  if (Chart->unpacker() != NULL
+      && (Chart->unpacker()->exhausted()
+          || readings.size() >= (size_t) opt_nsolutions))
+    Chart->unpacker(NULL);
+
+  stats.readings = readings.size();
+  return readings.size() - before;
 }
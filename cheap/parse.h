@@ -25,8 +25,11 @@
 #define _PARSE_H_
 
 #include "item.h"
+#include "task.h"
+#include "tsdb++.h"
 #include "errors.h"
 #include "cheaptimer.h"
+#include "chunk-alloc.h"
 #include <string>
 #include <list>
 #include <vector>
@@ -49,6 +52,85 @@ extern timer TotalParseTime;
 extern clock_t timeout;
 extern clock_t timestamp;
 
+/** The state of the parser that belongs to one client of the parser.
+ *
+ * For efficiency, the parser keeps everything it needs during the analysis
+ * of one input in globals: the chart and the agenda, the statistics, the
+ * temporary chunk allocator \c t_alloc holding all non-permanent dags, the
+ * current unifier generation, the resource clocks, the grandparenting
+ * paths of selective unpacking (see tPathTable), and the owner and id
+ * counter of new chart items (see tItem::default_owner()), which must
+ * not be shared because items unpacked later belong to the chart of their
+ * own context. A tParseContext owns
+ * a private instance of all of these and exchanges it with the globals while
+ * it is active, such that several clients (server sessions, workers) can use
+ * one loaded grammar in turn without clobbering each other's charts and
+ * temporary dags, e.g., to keep a packed forest around for later unpacking
+ * while other inputs are parsed.
+ *
+ * A context has to be active from the creation of the fs_alloc_state that is
+ * passed to analyze() until the results have been used up. Contexts nest:
+ * activate() saves the state that was active before and deactivate()
+ * restores it.
+ *
+ * Only one context can be active at a time, so this does not allow
+ * concurrent calls of analyze(): clients take turns, and a parse runs to
+ * completion in the context that started it. The following state is still
+ * global and shared by all contexts:
+ * - the maximal unifier generation: it validates scratch slots that live in
+ *   the shared permanent dags of the grammar and must therefore grow
+ *   monotonically for the whole process. This alone rules out two contexts
+ *   unifying at the same time.
+ * - the lexical parser singleton \c Lexparser, which is reset after every
+ *   input.
+ * - the candidate vectors of the batched quick check (\c qc_items,
+ *   \c qc_rules etc. in parse.cpp), scratch space that is refilled by every
+ *   postulate() and fundamental rule call.
+ * - the unification failure cache (\c fail_cache in task.cpp), whose keys are
+ *   rule numbers and daughter fingerprints and hence valid for every input.
+ * - the task id counter \c basic_task::next_id.
+ */
+class tParseContext {
+public:
+  tParseContext();
+  ~tParseContext();
+
+  /** Make this the state used by the parser. */
+  void activate();
+  /** Give back the state that was active before activate() was called. */
+  void deactivate();
+  /** Is this context currently installed in the parser globals? */
+  bool active() const { return _active; }
+
+  /** Activate a context for the lifetime of a scope. */
+  class scope {
+  public:
+    scope(tParseContext &ctx) : _ctx(ctx) { _ctx.activate(); }
+    ~scope() { _ctx.deactivate(); }
+  private:
+    tParseContext &_ctx;
+  };
+
+private:
+  tParseContext(const tParseContext &);
+  tParseContext &operator=(const tParseContext &);
+
+  /** Exchange the parser globals with the private state. */
+  void swap_state();
+
+  class chart *_chart;
+  tAbstractAgenda *_agenda;
+  statistics _stats;
+  chunk_allocator _t_alloc;
+  /** only used with the Tomabechi unifier */
+  int _unify_generation;
+  clock_t _timeout, _timestamp;
+  tPathTable::tables _paths;
+  item_owner *_default_owner;
+  int _next_item_id;
+  bool _active;
+};
+
 /** test whether a global resource limit has been exhausted */
 extern bool test_resource_limits(std::string &);
 
@@ -61,14 +143,25 @@ extern bool test_resource_limits(std::string &);
  *             allocated memory during and after parsing.
  * \param errors The errors occured during parsing, e.g., resource exhaustion
  * \param id A unique id for this parse.
+ * \param lazy If \c true and the forest is unpacked selectively, only the
+ *             best reading is unpacked, the others are left to
+ *             unpack_readings().
  */
 void analyze(std::string input, class chart *&C, class fs_alloc_state &FSAS,
-             std::list<tError> &errors, int id = 0);
+             std::list<tError> &errors, int id = 0, bool lazy = false);
+
+/** Unpack further readings of the last lazy analyze() until the chart has
+ *  \a n readings (at most \c opt_nsolutions) or the forest is exhausted.
+ *  The context of that parse has to be active.
+ * \return the number of readings added to the chart
+ */
+int unpack_readings(size_t n, std::list<tError> &errors);
 
 /** selective unpacking */
 int unpack_selectively(std::vector<tItem*> &trees, int upedgelimit,
                        long memlimit, int nsolutions, 
-                       timer *UnpackTime , std::vector<tItem *> &readings);
+                       timer *UnpackTime , std::vector<tItem *> &readings,
+                       bool lazy = false);
 
 /** exhaustive unpacking */
 int unpack_exhaustively(std::vector<tItem*> &trees, int upedgelimit,
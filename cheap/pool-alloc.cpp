@@ -0,0 +1,51 @@
+/* PET
+ * Platform for Experimentation with efficient HPSG processing Techniques
+ * (C) 1999 - 2002 Ulrich Callmeier uc@coli.uni-sb.de
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* size class arenas for chart items, hypotheses and tasks */
+
+#include "pool-alloc.h"
+
+#include <cstring>
+#include <new>
+
+pool_allocator::pool_allocator() {
+  memset(_free, 0, sizeof(_free));
+}
+
+pool_allocator::~pool_allocator() {
+  for(std::vector<char *>::iterator it = _chunks.begin();
+      it != _chunks.end(); ++it)
+    ::operator delete(*it);
+}
+
+void *
+pool_allocator::refill(size_t c) {
+  size_t size = (c + 1) * GRANULE;
+  char *chunk = static_cast<char *>(::operator new(POOL_CHUNK_SIZE));
+  _chunks.push_back(chunk);
+
+  // the first block is returned, the others go to the free list
+  size_t n = POOL_CHUNK_SIZE / size;
+  for(size_t i = n - 1; i >= 1; --i) {
+    free_block *b = reinterpret_cast<free_block *>(chunk + i * size);
+    b->next = _free[c];
+    _free[c] = b;
+  }
+  return chunk;
+}
@@ -0,0 +1,133 @@
+/* PET
+ * Platform for Experimentation with efficient HPSG processing Techniques
+ * (C) 1999 - 2002 Ulrich Callmeier uc@coli.uni-sb.de
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file pool-alloc.h
+ * Arenas for the objects that are created and destroyed in large numbers
+ * during parsing (chart items, hypotheses and tasks).
+ */
+
+#ifndef _POOL_ALLOC_H_
+#define _POOL_ALLOC_H_
+
+#include <cstddef>
+#include <vector>
+
+/** An arena of memory blocks in a small number of size classes.
+ *
+ * Memory is taken from the system in big chunks and cut into blocks of the
+ * requested size class. Freed blocks go to a free list for their class and
+ * are reused by the next allocation of that size within the same arena.
+ * All chunks are given back to the system at once when the arena is
+ * destroyed, so an arena that belongs to one parse (see item_owner and
+ * abstract_agenda) releases the memory of that parse in one step, no matter
+ * how long other parses keep their charts. Requests bigger than the largest
+ * size class are passed on to the system allocator.
+ */
+class pool_allocator
+{
+ public:
+  pool_allocator();
+  ~pool_allocator();
+
+  /** Get a block of at least \a n bytes */
+  inline void *allocate(size_t n) {
+    if(n > MAX_BLOCK) return ::operator new(n);
+    size_t c = size_class(n);
+    if(_free[c] == NULL) return refill(c);
+    free_block *b = _free[c];
+    _free[c] = b->next;
+    return b;
+  }
+
+  /** Return the block \a p of \a n bytes (the size it was allocated with) */
+  inline void deallocate(void *p, size_t n) {
+    if(p == NULL) return;
+    if(n > MAX_BLOCK) { ::operator delete(p); return; }
+    size_t c = size_class(n);
+    free_block *b = static_cast<free_block *>(p);
+    b->next = _free[c];
+    _free[c] = b;
+  }
+
+  /** Get \a n bytes from \a pool, or from the system allocator if \a pool
+   *  is \c NULL. The block remembers where it came from, so release() needs
+   *  no arena.
+   */
+  inline static void *allocate_from(pool_allocator *pool, size_t n) {
+    block_header *h = static_cast<block_header *>(
+      (pool != NULL) ? pool->allocate(n + HEADER) : ::operator new(n + HEADER));
+    h->pool = pool;
+    return reinterpret_cast<char *>(h) + HEADER;
+  }
+
+  /** Give back the block \a p of \a n bytes obtained from allocate_from().
+   *  \pre The arena it came from still exists.
+   */
+  inline static void release(void *p, size_t n) {
+    if(p == NULL) return;
+    block_header *h
+      = reinterpret_cast<block_header *>(static_cast<char *>(p) - HEADER);
+    if(h->pool != NULL)
+      h->pool->deallocate(h, n + HEADER);
+    else
+      ::operator delete(h);
+  }
+
+ private:
+  pool_allocator(const pool_allocator &);
+  pool_allocator &operator=(const pool_allocator &);
+
+  /** Blocks are multiples of this size (which also provides alignment) */
+  static const size_t GRANULE = 16;
+  /** The largest block size that is served from the pool */
+  static const size_t MAX_BLOCK = 512;
+  static const size_t NCLASSES = MAX_BLOCK / GRANULE;
+  /** The size of the chunks taken from the system */
+  static const size_t POOL_CHUNK_SIZE = 64 * 1024;
+
+  struct free_block { free_block *next; };
+  /** Prefix of the blocks of allocate_from(), one granule to keep the
+   *  alignment */
+  struct block_header { pool_allocator *pool; };
+  static const size_t HEADER = GRANULE;
+
+  inline static size_t size_class(size_t n) {
+    return (n == 0) ? 0 : (n - 1) / GRANULE;
+  }
+
+  /** Cut a new chunk into blocks of class \a c and return the first one */
+  void *refill(size_t c);
+
+  free_block *_free[NCLASSES];
+  std::vector<char *> _chunks;
+};
+
+/** Add class specific new and delete operators that take the memory of the
+ *  objects from the arena \a POOL (an expression of type pool_allocator *,
+ *  evaluated for every new; \c NULL means the system heap). The class must
+ *  have a virtual destructor if objects of derived classes are deleted
+ *  through a pointer to it, so that delete gets the right size.
+ */
+#define POOL_ALLOCATED(POOL)                                               \
+  static void *operator new(size_t n) {                                    \
+    return pool_allocator::allocate_from(POOL, n); }                       \
+  static void operator delete(void *p, size_t n) {                         \
+    pool_allocator::release(p, n); }
+
+#endif
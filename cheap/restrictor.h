@@ -11,6 +11,8 @@
 #include "list-int.h"
 #include "dag-tomabechi.h"
 
+#include <vector>
+
 /** Pure virtual restrictor superclass */
 class restrictor {
 public:
@@ -34,16 +36,26 @@ public:
  * not worthwile at the moment.
  */
 class list_int_restrictor : public restrictor {
-  list_int *_del_arcs;
+  /** One flag per attribute (up to the largest unwanted one), so that
+   *  prune_arc() does not have to walk the attribute list for every arc.
+   */
+  std::vector<bool> _del_arcs;
 
 public:
   /** Create a restrictor from a list of unwanted attributes */
-  list_int_restrictor(list_int *del) { _del_arcs = copy_list(del); }
-  virtual ~list_int_restrictor() { free_list(_del_arcs); }
+  list_int_restrictor(list_int *del) {
+    for(list_int *l = del; l != NULL; l = rest(l)) {
+      if(first(l) < 0) continue;
+      if(first(l) >= (int) _del_arcs.size())
+        _del_arcs.resize(first(l) + 1, false);
+      _del_arcs[first(l)] = true;
+    }
+  }
+  virtual ~list_int_restrictor() { }
 
   /** Return true if this arc should be deleted */
   inline bool prune_arc(attr_t attr) const {
-    return contains(_del_arcs, attr);
+    return attr < (attr_t) _del_arcs.size() && _del_arcs[attr];
   }
 
   virtual dag_node *dag_partial_copy (dag_node* dag) const {
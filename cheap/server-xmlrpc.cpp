@@ -38,14 +38,21 @@
 
 #include <cassert>
 #include <cerrno>
+#include <csignal>
 #include <cstring>
+#include <ctime>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <vector>
 #include <arpa/inet.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
 
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/girerr.hpp>
@@ -99,9 +106,586 @@ struct info_method : public xmlrpc_c::method
 };
 
 
+/** The outcome of analyzing one input.
+ *  Only plain strings are stored here, such that a result can be passed from
+ *  a worker process to the server process.
+ */
+struct tParseResult
+{
+  /** the error message, or the empty string if there was no error */
+  string error;
+  /** the surface string of the input */
+  string surface;
+  /** the number of readings */
+  int nreadings;
+  /** the derivations of the readings, if requested */
+  vector<string> derivations;
+  /** the MRSs of the readings, if requested and \c opt_mrs is set */
+  vector<string> mrss;
+
+  tParseResult() : nreadings(0) {}
+};
+
+/** Return the MRS of \a item in the format selected by \c opt_mrs */
+static string
+extract_mrs(tItem *item, const string &opt_mrs)
+{
+  string mrs_str;
+  if ((opt_mrs == "new") || (opt_mrs == "simple")) {
+    ostringstream osstream;
+    fs f = item->get_fs();
+    mrs::tPSOA* mrs = new mrs::tPSOA(f.dag());
+    if (mrs->valid()) {
+      mrs::tPSOA* mapped_mrs = vpm->map_mrs(mrs, true);
+      if (mapped_mrs->valid()) {
+        if (opt_mrs == "new") {
+          MrxMRSPrinter ptr(osstream);
+          ptr.print(mapped_mrs);
+        } else if (opt_mrs == "simple") {
+          SimpleMRSPrinter ptr(osstream);
+          ptr.print(mapped_mrs);
+        }
+      }
+      delete mapped_mrs;
+    }
+    delete mrs;
+    mrs_str = osstream.str();
+  } else {
+#ifdef HAVE_MRS
+    mrs_str = ecl_cpp_extract_mrs(item->get_fs().dag(), opt_mrs.c_str());
+#else
+    mrs_str = "";
+#endif
+  }
+  return mrs_str;
+}
+
+/** Analyze \a input and store the readings into \a result.
+ * \param derivformat the derivation printing format (`udf' or `compact'),
+ *        or the empty string if only the number of readings is needed.
+ */
+static void
+analyze_input(const string &input, const string &derivformat,
+              tParseResult &result)
+{
+  // analyze string:
+  chart *Chart = 0;
+  fs_alloc_state FSAS;
+  int id = 1;
+  try {
+    list<tError> errors;
+    analyze(input, Chart, FSAS, errors, id);
+    // this looks rather strange, but it seems to be the current paradigm
+    if (!errors.empty())
+      throw errors.front();
+  } catch (tError e) {
+    result.error = e.getMessage();
+  }
+
+  // collect readings:
+  if (result.error.empty()) {
+    result.nreadings = Chart->readings().size();
+    result.surface = Chart->get_surface_string();
+    if (!derivformat.empty()) {
+      string opt_mrs = get_opt_string("opt_mrs");
+      for (vector<tItem*>::iterator it = Chart->readings().begin();
+           it != Chart->readings().end(); ++it) {
+        tItem *item = *it;
+
+        // get derivation:
+        ostringstream osstream;
+        if (derivformat == "udf")
+          tTSDBDerivationPrinter(osstream, 1).print(item);
+        else if (derivformat == "compact")
+          tCompactDerivationPrinter(osstream).print(item);
+        result.derivations.push_back(osstream.str());
+
+        // get MRS:
+        if (!opt_mrs.empty())
+          result.mrss.push_back(extract_mrs(item, opt_mrs));
+      }
+    }
+  }
+
+  // delete resources:
+  if (Chart != 0)
+    delete Chart;
+}
+
+
+/** @name Worker protocol
+ * Requests and results are passed between the server and its workers as
+ * sequences of length-prefixed strings over a pair of pipes.
+ */
+//@{
+static bool
+write_all(int fd, const char *buf, size_t n)
+{
+  while (n > 0) {
+    ssize_t written = write(fd, buf, n);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    buf += written; n -= written;
+  }
+  return true;
+}
+
+static bool
+read_all(int fd, char *buf, size_t n)
+{
+  while (n > 0) {
+    ssize_t got = read(fd, buf, n);
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (got == 0) return false; // end of file
+    buf += got; n -= got;
+  }
+  return true;
+}
+
+static bool
+write_int(int fd, uint32_t n)
+{
+  return write_all(fd, (const char *) &n, sizeof(n));
+}
+
+static bool
+read_int(int fd, uint32_t &n)
+{
+  return read_all(fd, (char *) &n, sizeof(n));
+}
+
+static bool
+write_string(int fd, const string &s)
+{
+  return write_int(fd, s.size()) && write_all(fd, s.data(), s.size());
+}
+
+static bool
+read_string(int fd, string &s)
+{
+  uint32_t len;
+  if (!read_int(fd, len)) return false;
+  s.resize(len);
+  return (len == 0) || read_all(fd, &s[0], len);
+}
+
+static bool
+write_strings(int fd, const vector<string> &v)
+{
+  if (!write_int(fd, v.size())) return false;
+  for (vector<string>::const_iterator it = v.begin(); it != v.end(); ++it)
+    if (!write_string(fd, *it)) return false;
+  return true;
+}
+
+static bool
+read_strings(int fd, vector<string> &v)
+{
+  uint32_t n;
+  if (!read_int(fd, n)) return false;
+  v.resize(n);
+  for (vector<string>::iterator it = v.begin(); it != v.end(); ++it)
+    if (!read_string(fd, *it)) return false;
+  return true;
+}
+
+static bool
+write_result(int fd, const tParseResult &result)
+{
+  return write_string(fd, result.error)
+    && write_string(fd, result.surface)
+    && write_int(fd, result.nreadings)
+    && write_strings(fd, result.derivations)
+    && write_strings(fd, result.mrss);
+}
+
+static bool
+read_result(int fd, tParseResult &result)
+{
+  uint32_t n;
+  if (!(read_string(fd, result.error)
+        && read_string(fd, result.surface)
+        && read_int(fd, n)
+        && read_strings(fd, result.derivations)
+        && read_strings(fd, result.mrss)))
+    return false;
+  result.nreadings = n;
+  return true;
+}
+
+/** Send the \a status of a spawn request over the unix socket \a sock,
+ *  which is the pid of the new worker or the negated \c errno. With a pid,
+ *  the server's ends \a to and \a from of the worker pipes are passed along.
+ */
+static bool
+send_worker(int sock, int32_t status, int to, int from)
+{
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  struct iovec iov;
+  iov.iov_base = &status;
+  iov.iov_len = sizeof(status);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  char control[CMSG_SPACE(2 * sizeof(int))];
+  if (status > 0) {
+    memset(control, 0, sizeof(control));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    int fds[2] = { to, from };
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+  }
+
+  ssize_t n;
+  while ((n = sendmsg(sock, &msg, 0)) < 0 && errno == EINTR)
+    ;
+  return n == (ssize_t) sizeof(status);
+}
+
+/** Receive what send_worker() sent. */
+static bool
+recv_worker(int sock, int32_t &status, int &to, int &from)
+{
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  struct iovec iov;
+  iov.iov_base = &status;
+  iov.iov_len = sizeof(status);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  char control[CMSG_SPACE(2 * sizeof(int))];
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t n;
+  while ((n = recvmsg(sock, &msg, 0)) < 0 && errno == EINTR)
+    ;
+  if (n != (ssize_t) sizeof(status))
+    return false;
+  if (status <= 0)
+    return true;
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET
+      || cmsg->cmsg_type != SCM_RIGHTS
+      || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+    return false;
+  int fds[2];
+  memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  to = fds[0];
+  from = fds[1];
+  return true;
+}
+//@}
+
+
+/**
+ * The parse workers of the server.
+ *
+ * The parser itself can only analyze one input at a time per process, since
+ * the unifier keeps its scratch data in the (shared) grammar structures. To
+ * serve several clients in parallel, the pool forks \c opt_server_workers
+ * worker processes after the grammar has been loaded. All workers share the
+ * grammar pages with the server process (copy on write) and each has its own
+ * allocators and caches. A request waits in a bounded queue until a worker is
+ * idle; if more than \c opt_server_queue requests are waiting already, it is
+ * rejected immediately. A worker that dies is replaced by a fresh one.
+ *
+ * The workers are not forked by the server itself: once the connection
+ * threads run, a child of the server would inherit the locks the other
+ * threads hold at that moment (in malloc, the iostreams, the logger) and
+ * could deadlock. Instead, a single threaded spawner process is forked
+ * before the threads start. It forks the workers on request and passes the
+ * server's ends of their pipes back over a unix socket. If a worker cannot
+ * be started, its slot is retried at most once a second; while no worker
+ * at all is available, requests fail with an error rather than wait.
+ *
+ * Without workers, the requests are processed one at a time in the server
+ * process.
+ */
+class tWorkerPool
+{
+public:
+  tWorkerPool(int nworkers, int maxqueue);
+  ~tWorkerPool();
+
+  /** Analyze \a input in some worker, see analyze_input(). */
+  void process(const string &input, const string &derivformat,
+               tParseResult &result);
+
+private:
+  struct worker
+  {
+    pid_t pid;
+    /** pipe to send requests to the worker */
+    int to;
+    /** pipe to receive results from the worker */
+    int from;
+  };
+
+  /** Start a (new) worker process in slot \a i */
+  void spawn(int i);
+  /** Stop the worker in slot \a i */
+  void reap(int i);
+  /** Try to start workers in the dead slots again, at most once a second */
+  void revive();
+  /** The main loop of the spawner process, does not return */
+  static void spawner(int sock);
+  /** The main loop of a worker process, does not return */
+  static void serve(int in, int out);
+
+  vector<worker> _workers;
+  /** the slots of the workers waiting for requests */
+  vector<int> _idle;
+  /** the slots without a worker because it could not be started */
+  vector<int> _dead;
+  /** the earliest time to try the dead slots again */
+  time_t _retry;
+  /** the socket to the spawner process, and its pid */
+  int _spawner;
+  pid_t _spawner_pid;
+  int _maxqueue;
+  /** the number of requests waiting for a worker */
+  int _waiting;
+  pthread_mutex_t _mutex;
+  pthread_cond_t _idle_cond;
+};
+
+tWorkerPool::tWorkerPool(int nworkers, int maxqueue)
+  : _workers(nworkers), _retry(0), _spawner(-1), _spawner_pid(-1),
+    _maxqueue(maxqueue), _waiting(0)
+{
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_idle_cond, NULL);
+  if (nworkers == 0) return;
+
+  int sock[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sock) == -1)
+    throw tError((std::string)"Unable to create spawner socket: "
+                 + strerror(errno));
+  _spawner_pid = fork();
+  if (_spawner_pid == -1)
+    throw tError((std::string)"Unable to fork worker spawner: "
+                 + strerror(errno));
+  if (_spawner_pid == 0) {
+    close(sock[0]);
+    spawner(sock[1]);
+  }
+  close(sock[1]);
+  _spawner = sock[0];
+
+  for (int i = 0; i < nworkers; ++i) {
+    _workers[i].pid = -1;
+    try {
+      spawn(i);
+      _idle.push_back(i);
+    } catch (tError e) {
+      cerr << "[XML-RPC server] " << e.getMessage() << '\n';
+      _dead.push_back(i);
+      _retry = time(NULL) + 1;
+    }
+  }
+}
+
+tWorkerPool::~tWorkerPool()
+{
+  for (int i = 0; i < (int) _workers.size(); ++i)
+    reap(i);
+  if (_spawner_pid > 0) {
+    close(_spawner);   // the spawner exits at end of file
+    waitpid(_spawner_pid, NULL, 0);
+  }
+  pthread_cond_destroy(&_idle_cond);
+  pthread_mutex_destroy(&_mutex);
+}
+
+void
+tWorkerPool::spawner(int sock)
+{
+  // the workers are children of the spawner, which does not wait for them
+  signal(SIGCHLD, SIG_IGN);
+
+  char request;
+  while (read_all(sock, &request, 1)) {
+    int to[2], from[2];
+    int32_t status;
+    if (pipe(to) == -1) {
+      status = -errno;
+    } else if (pipe(from) == -1) {
+      status = -errno;
+      close(to[0]);
+      close(to[1]);
+    } else {
+      pid_t pid = fork();
+      if (pid == 0) {
+        signal(SIGCHLD, SIG_DFL);
+        close(sock);
+        close(to[1]);
+        close(from[0]);
+        serve(to[0], from[1]);
+      }
+      status = (pid == -1) ? -errno : pid;
+      close(to[0]);
+      close(from[1]);
+      if (pid == -1) {
+        close(to[1]);
+        close(from[0]);
+      }
+    }
+    bool ok = send_worker(sock, status, to[1], from[0]);
+    if (status > 0) {
+      // the server has its own copies now
+      close(to[1]);
+      close(from[0]);
+    }
+    if (!ok) break;
+  }
+  _exit(0);
+}
+
+void
+tWorkerPool::spawn(int i)
+{
+  char request = 's';
+  int32_t status;
+  int to, from;
+  if (!write_all(_spawner, &request, 1)
+      || !recv_worker(_spawner, status, to, from))
+    throw tError("Unable to reach the worker spawner");
+  if (status <= 0)
+    throw tError((std::string)"Unable to start worker: "
+                 + strerror(-status));
+
+  _workers[i].pid = status;
+  _workers[i].to = to;
+  _workers[i].from = from;
+  cerr << "[XML-RPC server] started worker " << status << '\n';
+}
+
+void
+tWorkerPool::reap(int i)
+{
+  if (_workers[i].pid <= 0) return;
+  close(_workers[i].to);   // the worker exits at end of file
+  close(_workers[i].from);
+  _workers[i].pid = -1;
+}
+
+void
+tWorkerPool::revive()
+{
+  if (_dead.empty() || time(NULL) < _retry) return;
+  vector<int> dead;
+  dead.swap(_dead);
+  for (vector<int>::iterator it = dead.begin(); it != dead.end(); ++it) {
+    try {
+      spawn(*it);
+      _idle.push_back(*it);
+      pthread_cond_signal(&_idle_cond);
+    } catch (tError e) {
+      cerr << "[XML-RPC server] " << e.getMessage() << '\n';
+      _dead.push_back(*it);
+    }
+  }
+  if (!_dead.empty())
+    _retry = time(NULL) + 1;
+}
+
+void
+tWorkerPool::serve(int in, int out)
+{
+  string input, derivformat;
+  while (read_string(in, input) && read_string(in, derivformat)) {
+    tParseResult result;
+    analyze_input(input, derivformat, result);
+    if (!write_result(out, result))
+      break;
+  }
+  _exit(0);
+}
+
+void
+tWorkerPool::process(const string &input, const string &derivformat,
+                     tParseResult &result)
+{
+  pthread_mutex_lock(&_mutex);
+  if (_workers.empty()) {
+    // no workers: analyze here, one request at a time
+    try {
+      analyze_input(input, derivformat, result);
+    } catch (...) {
+      pthread_mutex_unlock(&_mutex);
+      throw;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return;
+  }
+
+  revive();
+  if (_idle.empty() && _waiting >= _maxqueue) {
+    pthread_mutex_unlock(&_mutex);
+    result.error = "server busy: too many pending requests";
+    return;
+  }
+  ++_waiting;
+  while (_idle.empty()) {
+    if (_dead.size() == _workers.size()) {
+      // there is no worker that could become idle
+      --_waiting;
+      pthread_mutex_unlock(&_mutex);
+      result.error = "no worker process available";
+      return;
+    }
+    pthread_cond_wait(&_idle_cond, &_mutex);
+  }
+  --_waiting;
+  int i = _idle.back();
+  _idle.pop_back();
+  pthread_mutex_unlock(&_mutex);
+
+  worker &w = _workers[i];
+  bool ok = write_string(w.to, input) && write_string(w.to, derivformat)
+    && read_result(w.from, result);
+
+  pthread_mutex_lock(&_mutex);
+  if (!ok) {
+    // the worker died while processing this request, most probably because
+    // of it; report an error and start a replacement
+    cerr << "[XML-RPC server] worker " << w.pid << " died\n";
+    result = tParseResult();
+    result.error = "worker process died while processing the request";
+    reap(i);
+    try {
+      spawn(i);
+    } catch (tError e) {
+      cerr << "[XML-RPC server] " << e.getMessage() << '\n';
+      _dead.push_back(i);
+      _retry = time(NULL) + 1;
+      // the waiters have to find out whether any worker is left
+      pthread_cond_broadcast(&_idle_cond);
+      pthread_mutex_unlock(&_mutex);
+      return;
+    }
+  }
+  _idle.push_back(i);
+  pthread_cond_signal(&_idle_cond);
+  pthread_mutex_unlock(&_mutex);
+}
+
+
 struct analyze_method : public xmlrpc_c::method
 {
-  analyze_method()
+  analyze_method(tWorkerPool &pool) : _pool(pool)
   {
     _signature = "S:ss";
     _help = "Analyze the specified input and return the result. "
@@ -124,106 +708,40 @@ struct analyze_method : public xmlrpc_c::method
       params.verifyEnd(1);
     }
 
-    // Define a string that will hold the error message for errors that
-    // occurred during parsing or be empty if there were no errors.
-    // This kind of error handling is a bit clumsy. But it makes it easier
-    // to cleanup the resources acquired during analyze(). A better solution
-    // would be to use the RAII pattern for all required resources.
-    string error;
-
-    // analyze string:
-    chart *Chart = 0;
-    fs_alloc_state FSAS;
-    int id = 1;
-    try {
-      list<tError> errors;
-      analyze(input, Chart, FSAS, errors, id);
-      // this looks rather strange, but it seems to be the current paradigm
-      if (!errors.empty())
-        throw errors.front();
-    } catch (tError e) {
-      error = e.getMessage();
+    tParseResult result;
+    _pool.process(input, derivformat, result);
+
+    if (!result.error.empty()) {
+      // rethrow as girerr::error to make the message available to the client
+      throw girerr::error(result.error);
     }
 
     // collect readings:
-    if (error.empty()) {
-      vector<xmlrpc_c::value> readings_helper;
-      list<tItem*> readings(Chart->readings().begin(), Chart->readings().end());
-      for (list<tItem*>::iterator it=readings.begin(); it!=readings.end(); ++it)
-      {
-        tItem *item = *it;
-
-        // get derivation:
-        std::map<std::string, xmlrpc_c::value> reading_helper;
-        ostringstream osstream;
-        tTSDBDerivationPrinter printer(osstream, 1);
-        if (derivformat == "udf")
-          tTSDBDerivationPrinter(osstream, 1).print(item);
-        else if (derivformat == "compact")
-          tCompactDerivationPrinter(osstream).print(item);
-        reading_helper["derivation"] = xmlrpc_c::value_string(osstream.str());
-
-        // get MRS:
-        string opt_mrs = get_opt_string("opt_mrs");
-        if (!opt_mrs.empty()) {
-          string mrs_str;
-          if ((opt_mrs == "new") || (opt_mrs == "simple")) {
-            osstream.clear(); // reset state
-            osstream.str(""); // reset underlying buffer
-            fs f = item->get_fs();
-            mrs::tPSOA* mrs = new mrs::tPSOA(f.dag());
-            if (mrs->valid()) {
-              mrs::tPSOA* mapped_mrs = vpm->map_mrs(mrs, true);
-              if (mapped_mrs->valid()) {
-                if (opt_mrs == "new") {
-                  MrxMRSPrinter ptr(osstream);
-                  ptr.print(mapped_mrs);
-                } else if (opt_mrs == "simple") {
-                  SimpleMRSPrinter ptr(osstream);
-                  ptr.print(mapped_mrs);
-                }
-              }
-              delete mapped_mrs;
-            }
-            delete mrs;
-            mrs_str = osstream.str();
-          } else {
-#ifdef HAVE_MRS
-            mrs_str = ecl_cpp_extract_mrs(item->get_fs().dag(), opt_mrs.c_str());
-#else
-            mrs_str = "";
-#endif
-          }
-          reading_helper["mrs"] = xmlrpc_c::value_string(mrs_str);
-        }
-
-        // store reading:
-        readings_helper.push_back(xmlrpc_c::value_struct(reading_helper));
-      }
-
-      // prepare return value:
-      std::map<std::string, xmlrpc_c::value> results_helper;
-      results_helper["surface"] =
-        xmlrpc_c::value_string(Chart->get_surface_string());
-      results_helper["readings"] = xmlrpc_c::value_array(readings_helper);
-      *retval = xmlrpc_c::value_struct(results_helper);
+    vector<xmlrpc_c::value> readings_helper;
+    for (unsigned int i = 0; i < result.derivations.size(); ++i) {
+      std::map<std::string, xmlrpc_c::value> reading_helper;
+      reading_helper["derivation"] =
+        xmlrpc_c::value_string(result.derivations[i]);
+      if (i < result.mrss.size())
+        reading_helper["mrs"] = xmlrpc_c::value_string(result.mrss[i]);
+      readings_helper.push_back(xmlrpc_c::value_struct(reading_helper));
     }
 
-    // delete resources:
-    if (Chart != 0)
-      delete Chart;
-
-    if (!error.empty()) {
-      // rethrow as girerr::error to make the message available to the client
-      throw girerr::error(error);
-    }
+    // prepare return value:
+    std::map<std::string, xmlrpc_c::value> results_helper;
+    results_helper["surface"] = xmlrpc_c::value_string(result.surface);
+    results_helper["readings"] = xmlrpc_c::value_array(readings_helper);
+    *retval = xmlrpc_c::value_struct(results_helper);
   }
+
+private:
+  tWorkerPool &_pool;
 };
 
 
 struct parsable_method : public xmlrpc_c::method
 {
-  parsable_method()
+  parsable_method(tWorkerPool &pool) : _pool(pool)
   {
     _signature = "b:s";
     _help = "Analyze the specified input and return whether it is parsable.";
@@ -235,34 +753,15 @@ struct parsable_method : public xmlrpc_c::method
     string input(params.getString(0));
     params.verifyEnd(1);
 
-    // Define a string that will hold the error message for errors that
-    // occurred during parsing or be empty if there were no errors.
-    // This kind of error handling is a bit clumsy. But it makes it easier
-    // to cleanup the resources acquired during analyze(). A better solution
-    // would be to use the RAII pattern for all required resources.
-    string error;
-
-    // analyze string:
-    chart *Chart = 0;
-    fs_alloc_state FSAS;
-    int id = 1;
-    try {
-      list<tError> errors;
-      analyze(input, Chart, FSAS, errors, id);
-      // this looks rather strange, but it seems to be the current paradigm
-      if (!errors.empty())
-        throw errors.front();
-    } catch (tError e) {
-      error = e.getMessage();
-    }
-
-    bool result = error.empty() && !Chart->readings().empty();
-    *retval = xmlrpc_c::value_boolean(result);
+    tParseResult result;
+    _pool.process(input, "", result);
 
-    // delete resources:
-    if (Chart != 0)
-      delete Chart;
+    bool parsable = result.error.empty() && (result.nreadings > 0);
+    *retval = xmlrpc_c::value_boolean(parsable);
   }
+
+private:
+  tWorkerPool &_pool;
 };
 
 
@@ -292,11 +791,19 @@ tXMLRPCServer::run()
   if (!_socket)
     throw tError("Server socket is not initialized.");
 
+  // writing to a worker that just died must not kill the server
+  signal(SIGPIPE, SIG_IGN);
+
+  // fork the worker spawner before the server starts its threads
+  int nworkers = get_opt_int("opt_server_workers");
+  int maxqueue = get_opt_int("opt_server_queue");
+  tWorkerPool pool(nworkers, maxqueue);
+
   xmlrpc_c::registry reg;
   xmlrpc_c::methodPtr const alive_method_ptr(new alive_method);
   xmlrpc_c::methodPtr const info_method_ptr(new info_method);
-  xmlrpc_c::methodPtr const analyze_method_ptr(new analyze_method);
-  xmlrpc_c::methodPtr const parsable_method_ptr(new parsable_method);
+  xmlrpc_c::methodPtr const analyze_method_ptr(new analyze_method(pool));
+  xmlrpc_c::methodPtr const parsable_method_ptr(new parsable_method(pool));
   reg.addMethod("cheap.alive", alive_method_ptr);
   reg.addMethod("cheap.info", info_method_ptr);
   reg.addMethod("cheap.analyze", analyze_method_ptr);
@@ -306,10 +813,11 @@ tXMLRPCServer::run()
     .registryP(&reg)
     .socketFd(_socket)
     .uriPath(uri_path)
+    .maxConn(nworkers + maxqueue + 1)
     .logFileName("/dev/stderr"));
 
   cerr << "[XML-RPC server] waiting for clients at http://localhost:"
-       << _port << uri_path << '\n';
+       << _port << uri_path << " (" << nworkers << " workers)" << '\n';
   server.run();
   assert(false); // server.run() should never return
 }
@@ -16,8 +16,16 @@ SessionManager *SessionManager::_instance = NULL;
 
 typedef list<SessionManager::Session *>::iterator session_it;
 
+SessionManager::Session::Session(const string &in)
+  : id(++next_id), chart(NULL), input(in) {
+  tParseContext::scope active(context);
+  FSAS = new fs_alloc_state();
+}
+
 SessionManager::Session::~Session() {
+  tParseContext::scope active(context);
   delete chart;
+  delete FSAS;
 }
 
 SessionManager::Session *SessionManager::new_session(const string &input) {
@@ -74,7 +82,9 @@ int SessionManager::run_parser(int session_id) {
   Session *curr = find_session(session_id);
   if (curr == NULL) return NO_SUCH_SESSION;
   try {
-    analyze(curr->input, curr->chart, curr->FSAS, curr->errors, curr->id);
+    tParseContext::scope active(curr->context);
+    analyze(curr->input, curr->chart, *curr->FSAS, curr->errors, curr->id,
+            true);
   }
   catch(tError err) {
     //LOG(logAppl, ERROR, err.getMessage());
@@ -84,17 +94,42 @@ int SessionManager::run_parser(int session_id) {
   return (curr->errors.empty()) ? NO_ERRORS : ERRORS_PRESENT;
 }
 
+/** Unpack the readings of \a curr until there are \a n of them */
+static void unpack_session(SessionManager::Session *curr, size_t n) {
+  if (curr->chart == NULL || curr->chart->unpacker() == NULL
+      || curr->chart->readings().size() >= n)
+    return;
+  tParseContext::scope active(curr->context);
+  unpack_readings(n, curr->errors);
+}
+
 /** Return the number of results found */
 int SessionManager::results(int session_id) {
   Session *curr = find_session(session_id);
   if (curr == NULL) return NO_SUCH_SESSION;
+  if (curr->chart == NULL) return 0;
+  unpack_session(curr, get_opt_int("opt_nsolutions"));
+  return curr->chart->readings().size();
+}
+
+/** Return the number of results unpacked so far */
+int SessionManager::results(int session_id, bool &more) {
+  Session *curr = find_session(session_id);
+  if (curr == NULL) return NO_SUCH_SESSION;
+  if (curr->chart == NULL) {
+    more = false;
+    return 0;
+  }
+  more = (curr->chart->unpacker() != NULL);
   return curr->chart->readings().size();
 }
 
 /** return specified result item, or NULL, if illegal */
 class tItem * SessionManager::get_result_item(int session_id, size_t no) {
   Session *curr = find_session(session_id);
-  if (curr != NULL && no < curr->chart->readings().size()) {
+  if (curr == NULL || curr->chart == NULL) return NULL;
+  unpack_session(curr, no + 1);
+  if (no < curr->chart->readings().size()) {
     return curr->chart->readings()[no];
   }
   return NULL;
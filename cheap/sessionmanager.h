@@ -4,6 +4,7 @@
 #define _SESSIONMANAGER_H
 
 #include "fs.h"
+#include "parse.h"
 #include <list>
 
 #define NO_SUCH_SESSION -2
@@ -18,12 +19,17 @@ public:
     static int next_id;
 
     int id;
+    /** The parser state of this session: the packed forest and the readings
+     *  that are not unpacked yet stay alive in it between the calls.
+     */
+    tParseContext context;
     struct chart *chart;
-    fs_alloc_state FSAS;
+    /** allocated while \c context is active */
+    fs_alloc_state *FSAS;
     std::list<tError> errors;
     std::string input;
 
-    Session(const std::string &in) : id(++next_id), chart(NULL), input(in) { }
+    Session(const std::string &in);
 
     ~Session();
   };
@@ -69,10 +75,19 @@ public:
    */
   int run_parser(int session_id);
 
-  /** Return the number of results found */
+  /** Return the number of results found. With selective unpacking, this
+   *  unpacks all readings up to \c opt_nsolutions.
+   */
   int results(int session_id);
 
-  /** Get result item number \c result_no of session \c session_id
+  /** Return the number of results unpacked so far, without unpacking any
+   *  more. \a more is set to \c true if there may be further results, which
+   *  get_result_item() will unpack on demand.
+   */
+  int results(int session_id, bool &more);
+
+  /** Get result item number \c result_no of session \c session_id,
+   *  unpacking the readings up to it if necessary.
    *  \return NULL if either the session id is not valid or there is no such
    *          result
    */
@@ -30,15 +30,22 @@
 #include "grammar.h"
 #include "item.h"
 #include "logging.h"
+#include "dumper.h"
 
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
 
 using namespace std;
 using namespace HASH_SPACE;
 
+/* First int of a binary model ("SMB\0"), followed by the format version */
+#define SM_BINARY_MAGIC 0x00424D53
+#define SM_BINARY_VERSION 2
+
 int
 tSMFeature::hash() const
 {
@@ -95,17 +102,59 @@ namespace HASH_SPACE {
 
 /** Maintains a mapping between features (instances of tSMFeature) and codes.
  *  Also maintains map from types, integers and strings to integers.
+ *
+ *  The features are stored in one flat array, and found through an open
+ *  addressing hash table of their codes, so that the whole index can be
+ *  written to and read from a binary model as it is.
  */
 class tSMMap
 {
  public:
     tSMMap()
-        : _n(0), _next_subfeature(INT_MIN)
-    {};
+        : _next_subfeature(INT_MIN), _frozen(false)
+    {
+        _offsets.push_back(0);
+        _slots.resize(MIN_SLOTS, -1);
+    };
 
+    /** Return the code of \a feature, adding it if it is not known yet */
     int
     featureToCode(const tSMFeature &feature);
 
+    /** Return the code of \a feature, or -1 if it is not known */
+    int
+    findFeature(const tSMFeature &feature) const;
+
+    /** Return the code of the feature made of the \a plen subfeatures in
+     *  \a prefix followed by the \a slen subfeatures in \a suffix, or -1 if
+     *  it is not known. \a hash is the partHash() of the whole feature, which
+     *  can be computed from the hashes of the parts with concatHash().
+     */
+    int
+    findFeature(const int *prefix, int plen, const int *suffix, int slen,
+                unsigned int hash) const;
+
+    /** Return the hash of the \a len subfeatures in \a v */
+    static inline unsigned int
+    partHash(const int *v, int len)
+    {
+        // a polynomial hash, so that the hashes of parts can be combined
+        unsigned int h = 0;
+        for(int i = 0; i < len; ++i)
+            h = h * HASH_BASE + (unsigned int) v[i] + HASH_OFFSET;
+        return h;
+    }
+
+    /** Return the partHash() of the concatenation of a part with hash \a h1
+     *  and a part of \a len2 subfeatures with hash \a h2. */
+    static inline unsigned int
+    concatHash(unsigned int h1, unsigned int h2, int len2)
+    {
+        for(int i = 0; i < len2; ++i)
+            h1 *= HASH_BASE;
+        return h1 + h2;
+    }
+
     tSMFeature
     codeToFeature(int code) const;
 
@@ -120,41 +169,141 @@ class tSMMap
     int
     stringToSubfeature(const string &);
 
+    /** Do not add strings any more: unknown strings are mapped to a
+     *  subfeature that occurs in no feature. Models call this when they have
+     *  been loaded, so that scoring does not make the maps grow.
+     */
+    void
+    freeze()
+    { _frozen = true; }
+
+    /** Write the features, their index and the strings to \a f */
+    void
+    dump(dumper *f) const;
+
+    /** Read what dump() wrote from \a f */
+    void
+    undump(dumper *f);
+
  private:
-    /* Mapping between codes and features */
-    int _n;
-    vector<tSMFeature> _codeToFeature;
-    hash_map<tSMFeature, int> _featureToCode;
+    static const int MIN_SLOTS = 1024;
+    static const unsigned int HASH_BASE = 0x01000193u;
+    static const unsigned int HASH_OFFSET = 0x9e3779b9u;
+
+    /** Return the slot of the feature made of \a prefix and \a suffix (see
+     *  findFeature()), or of the empty slot where it would have to go. */
+    int
+    findSlot(const int *prefix, int plen, const int *suffix, int slen,
+             unsigned int hash) const;
+
+    inline int
+    findSlot(const int *v, int len) const
+    { return findSlot(v, len, 0, 0, partHash(v, len)); }
+
+    void
+    rehash(int nslots);
+
+    /* Mapping between codes and features: the subfeatures of feature \c n
+       are _subfeatures[_offsets[n]] ... _subfeatures[_offsets[n+1] - 1] */
+    vector<int> _subfeatures;
+    vector<int> _offsets;
+    /* Hash table of feature codes, -1 marks an empty slot. The size is a
+       power of two and at least twice the number of features. */
+    vector<int> _slots;
 
     /* Subfeature mapping */
     int _next_subfeature;
     hash_map<string, int, bj_string_hash> _stringToSubfeature;
+    bool _frozen;
 };
 
+int
+tSMMap::findSlot(const int *prefix, int plen, const int *suffix, int slen,
+                 unsigned int hash) const
+{
+    // mix the bits, the polynomial hash is weak in the low bits
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+
+    int mask = _slots.size() - 1;
+    int slot = hash & mask;
+    while(_slots[slot] != -1)
+    {
+        int code = _slots[slot];
+        int start = _offsets[code];
+        if(_offsets[code + 1] - start == plen + slen
+           && std::equal(prefix, prefix + plen, _subfeatures.begin() + start)
+           && std::equal(suffix, suffix + slen,
+                         _subfeatures.begin() + start + plen))
+            return slot;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void
+tSMMap::rehash(int nslots)
+{
+    _slots.assign(nslots, -1);
+    int n = _offsets.size() - 1;
+    for(int code = 0; code < n; ++code)
+    {
+        int start = _offsets[code];
+        int len = _offsets[code + 1] - start;
+        const int *v = len ? &_subfeatures[start] : 0;
+        _slots[findSlot(v, len)] = code;
+    }
+}
+
 int
 tSMMap::featureToCode(const tSMFeature &feature)
 {
     LOG(logSM, DEBUG, "featureToCode(" << feature << ") -> ");
 
-    hash_map<tSMFeature, int>::iterator itMatch = _featureToCode.find(feature);
-    if(itMatch != _featureToCode.end())
+    const vector<int> &v = feature.subfeatures();
+    int len = v.size();
+    int slot = findSlot(len ? &v[0] : 0, len);
+    if(_slots[slot] != -1)
     {
-        LOG(logSM, DEBUG, itMatch->second);
-        return itMatch->second;
+        LOG(logSM, DEBUG, _slots[slot]);
+        return _slots[slot];
     }
+
+    int code = _offsets.size() - 1;
+    LOG(logSM, DEBUG, "added " << code);
+    _subfeatures.insert(_subfeatures.end(), v.begin(), v.end());
+    _offsets.push_back(_subfeatures.size());
+    if(2 * (code + 1) > (int) _slots.size())
+        rehash(2 * _slots.size());
     else
-    {
-        LOG(logSM, DEBUG, "added " << _n);
-        _codeToFeature.push_back(feature);
-        return _featureToCode[feature] = _n++;
-    }
+        _slots[slot] = code;
+    return code;
+}
+
+int
+tSMMap::findFeature(const tSMFeature &feature) const
+{
+    const vector<int> &v = feature.subfeatures();
+    int len = v.size();
+    return _slots[findSlot(len ? &v[0] : 0, len)];
+}
+
+int
+tSMMap::findFeature(const int *prefix, int plen, const int *suffix, int slen,
+                    unsigned int hash) const
+{
+    return _slots[findSlot(prefix, plen, suffix, slen, hash)];
 }
 
 tSMFeature
 tSMMap::codeToFeature(int code) const
 {
-    if(code >= 0 && code < _n)
-        return _codeToFeature[code];
+    if(code >= 0 && code < (int) _offsets.size() - 1)
+        return vector<int>(_subfeatures.begin() + _offsets[code],
+                           _subfeatures.begin() + _offsets[code + 1]);
     else
         return vector<int>();
 }
@@ -168,12 +317,79 @@ tSMMap::stringToSubfeature(const string &s)
     {
         return itMatch->second;
     }
+    else if(_frozen)
+    {
+        // never assigned to a string, so it is in no feature
+        return _next_subfeature;
+    }
     else
     {
         return _stringToSubfeature[s] = _next_subfeature++;
     }
 }
 
+static void
+dump_int_vector(dumper *f, const vector<int> &v)
+{
+    f->dump_int(v.size());
+    for(vector<int>::const_iterator it = v.begin(); it != v.end(); ++it)
+        f->dump_int(*it);
+}
+
+static void
+undump_int_vector(dumper *f, vector<int> &v)
+{
+    int n = f->undump_int();
+    if(n < 0)
+        throw tError("corrupt binary model");
+    v.resize(n);
+    for(int i = 0; i < n; ++i)
+        v[i] = f->undump_int();
+}
+
+void
+tSMMap::dump(dumper *f) const
+{
+    // the strings in the order of their subfeatures, so that undumping
+    // assigns the same subfeatures again
+    vector<string> strings(_next_subfeature - INT_MIN);
+    for(hash_map<string, int, bj_string_hash>::const_iterator it =
+          _stringToSubfeature.begin(); it != _stringToSubfeature.end(); ++it)
+        strings[it->second - INT_MIN] = it->first;
+    f->dump_int(strings.size());
+    for(vector<string>::iterator it = strings.begin();
+        it != strings.end(); ++it)
+        f->dump_string(it->c_str());
+
+    dump_int_vector(f, _offsets);
+    dump_int_vector(f, _subfeatures);
+    dump_int_vector(f, _slots);
+}
+
+void
+tSMMap::undump(dumper *f)
+{
+    int nstrings = f->undump_int();
+    _stringToSubfeature.clear();
+    _next_subfeature = INT_MIN;
+    for(int i = 0; i < nstrings; ++i)
+    {
+        char *str = f->undump_string();
+        _stringToSubfeature[str] = _next_subfeature++;
+        delete[] str;
+    }
+
+    undump_int_vector(f, _offsets);
+    undump_int_vector(f, _subfeatures);
+    undump_int_vector(f, _slots);
+
+    int nslots = _slots.size();
+    if(_offsets.empty() || _offsets.back() != (int) _subfeatures.size()
+       || nslots < 2 * ((int) _offsets.size() - 1)
+       || (nslots & (nslots - 1)) != 0)
+        throw tError("corrupt feature index in binary model");
+}
+
 tSM::tSM(tGrammar *G, const char *fileName, const char *basePath)
     : _G(G), _map(0) {
   _fileName = find_file(fileName, SM_EXT, basePath);
@@ -301,79 +517,116 @@ tSM::scoreLeaf(tLexItem *it)
 }
 
 double
-tSM::score_hypothesis(tHypothesis* hypo, list<tItem*> path, unsigned int gplevel)
+tSM::score_hypothesis(tHypothesis* hypo, int pathid, unsigned int gplevel)
 {
-  vector<int> v1, v2;
-  double total = neutralScore();
+  double total;
+  if (hypo->edge->rule() == NULL) { // tLexItem
+    total = localScore(hypo, pathid, gplevel);
+  } else { // tPhrasalItem
+    // the local features of a hypothesis only look at the edges of its
+    // daughters, so their score is the same for all hypotheses of a
+    // decomposition
+    tDecomposition *decomposition = hypo->decomposition;
+    double local;
+    if (decomposition == NULL) {
+      local = localScore(hypo, pathid, gplevel);
+    } else if (! decomposition->local_score(pathid, local)) {
+      local = localScore(hypo, pathid, gplevel);
+      decomposition->set_local_score(pathid, local);
+    }
+
+    total = neutralScore();
+    int newpath = tPathTable::extend(pathid, hypo->edge, gplevel);
+    for (list<tHypothesis*>::iterator hypo_dtr = hypo->hypo_dtrs.begin();
+         hypo_dtr != hypo->hypo_dtrs.end(); ++hypo_dtr) {
+      if (!(*hypo_dtr)->scored(newpath))
+        score_hypothesis(*hypo_dtr, newpath, gplevel);
+      total = combineScores(total, (*hypo_dtr)->score(newpath));
+    }
+    total = combineScores(total, local);
+  }
+  hypo->set_score(pathid, total);
+  return total;
+}
+
+double
+tSM::localScore(tHypothesis* hypo, int pathid, unsigned int gplevel)
+{
+  // A feature is [tag, level, ancestors, local part], where tag 1 features
+  // have the edge and all its daughters as local part, and tag 2 features
+  // the edge and its key daughter. The local parts are hashed once, and the
+  // hashes of the prefixes for all levels are combined with them.
+  vector<int> local1, local2;
+  if (hypo->edge->rule() == NULL) { // tLexItem
+    // the lexical type and orth
+    tLexItem *lex = (tLexItem*)hypo->edge;
+    local1.push_back(map()->typeToSubfeature(lex->identity()));
+    local1.push_back(map()->stringToSubfeature(lex->orth()));
+  } else { // tPhrasalItem
+    tPhrasalItem *phrase = (tPhrasalItem*)hypo->edge;
+    local1.push_back(map()->typeToSubfeature(phrase->identity()));
+    int key = phrase->rule()->nextarg();
+    for (list<tHypothesis*>::iterator hypo_dtr = hypo->hypo_dtrs.begin();
+         hypo_dtr != hypo->hypo_dtrs.end(); ++hypo_dtr) {
+      local1.push_back((*hypo_dtr)->edge->identity());
+      if (--key == 0 && phrase->rule()->arity() > 1) {
+        local2.push_back(map()->typeToSubfeature(phrase->identity()));
+        local2.push_back((*hypo_dtr)->edge->identity());
+      }
+    }
+  }
+  unsigned int hash1 = tSMMap::partHash(&local1[0], local1.size());
+  unsigned int hash2 = tSMMap::partHash(local2.empty() ? 0 : &local2[0],
+                                        local2.size());
+
+  // the ancestors, nearest last, and the hashes of their suffixes
+  const list<tItem*> &path = tPathTable::path(pathid);
   size_t level = path.size();
   if (level > gplevel)  // we can only those levels we have ancestors for
     level = gplevel;
-  // collect grand-parenting features
-  for (int i = level; i >= 0; i -- ) {
-    v1.clear();
-    v2.clear();
-
-    v1.push_back(map()->intToSubfeature(1));
-    v2.push_back(map()->intToSubfeature(2));
-
-    v1.push_back(map()->intToSubfeature(i));
-    v2.push_back(map()->intToSubfeature(i));
-    // push down appropriate number of ancestors
-    unsigned int j = path.size();
-    for (list<tItem*>::iterator gp = path.begin();
-         gp != path.end(); ++gp, --j)
-      if (j <= (unsigned int)i) {
-        if (*gp == NULL) {
-          v1.push_back(INT_MAX);
-          v2.push_back(INT_MAX);
-        }
-        else {
-          v1.push_back((*gp)->identity());
-          v2.push_back((*gp)->identity());
-        }
-      }
-
-    if (hypo->edge->rule() == NULL) { // tLexItem
-      // push down the lexical type and orth
-      tLexItem *lex = (tLexItem*)hypo->edge;
-      v1.push_back(map()->typeToSubfeature(lex->identity()));
-      v1.push_back(map()->stringToSubfeature(lex->orth()));
-    } else { // tPhrasalItem
-      tPhrasalItem *phrase = (tPhrasalItem*)hypo->edge;
-      v1.push_back(map()->typeToSubfeature(phrase->identity()));
-      v2.push_back(map()->typeToSubfeature(phrase->identity()));
-      int key = phrase->rule()->nextarg();
-      list<tItem*> newpath = path;
-      newpath.push_back(hypo->edge);
-      if (newpath.size() > gplevel)
-        newpath.pop_front();
-      for (list<tHypothesis*>::iterator hypo_dtr = hypo->hypo_dtrs.begin();
-           hypo_dtr != hypo->hypo_dtrs.end(); ++hypo_dtr) {
-        v1.push_back((*hypo_dtr)->edge->identity());
-        if (i == 0) { // combine the scores of daughters only once
-          (*hypo_dtr)->scores.size(); //debug
-          if ((*hypo_dtr)->scores.find(newpath) == (*hypo_dtr)->scores.end())
-            score_hypothesis(*hypo_dtr, newpath, gplevel);
-          total = combineScores(total, (*hypo_dtr)->scores[newpath]);
-        }
-        if (--key == 0)
-          v2.push_back((*hypo_dtr)->edge->identity());
+  vector<int> prefix(2 + level);
+  vector<unsigned int> suffix_hash(level + 1);
+  list<tItem*>::const_reverse_iterator gp = path.rbegin();
+  unsigned int power = 1;
+  suffix_hash[level] = 0;
+  for (int k = level - 1; k >= 0; --k, ++gp) {
+    prefix[2 + k] = (*gp == NULL) ? INT_MAX : (*gp)->identity();
+    suffix_hash[k] = suffix_hash[k + 1]
+      + power * tSMMap::partHash(&prefix[2 + k], 1);
+    power = tSMMap::concatHash(power, 0, 1);
+  }
 
-      }
-      if (phrase->rule()->arity() > 1) {
-        total = combineScores(total, score(tSMFeature(v2)));
-      }
+  double total = neutralScore();
+  for (int i = level; i >= 0; i --) {
+    // the prefix for level i is [tag, i] and the i nearest ancestors; it is
+    // written over ancestors that are not needed for this and lower levels
+    int *p = &prefix[level - i];
+    int plen = 2 + i;
+    p[1] = map()->intToSubfeature(i);
+    unsigned int anc = suffix_hash[level - i];
+
+    if (! local2.empty()) {
+      p[0] = map()->intToSubfeature(2);
+      unsigned int h = tSMMap::concatHash(tSMMap::partHash(p, 2), anc, i);
+      h = tSMMap::concatHash(h, hash2, local2.size());
+      total = combineScores(total, scoreCode(map()->findFeature(p, plen,
+        &local2[0], local2.size(), h)));
     }
-    total = combineScores(total, score(tSMFeature(v1)));
+    p[0] = map()->intToSubfeature(1);
+    unsigned int h = tSMMap::concatHash(tSMMap::partHash(p, 2), anc, i);
+    h = tSMMap::concatHash(h, hash1, local1.size());
+    total = combineScores(total, scoreCode(map()->findFeature(p, plen,
+      &local1[0], local1.size(), h)));
   }
-  hypo->scores[path] = total;
-  return hypo->scores[path];
+  return total;
 }
 
 tMEM::tMEM(tGrammar *G, const char *fileNameIn, const char *basePath)
-  : tSM(G, fileNameIn, basePath), _format(0)
+  : tSM(G, fileNameIn, basePath), _format(0), _gplevel(-1)
 {
-    readModel(fileName());
+    if(!readBinary(fileName()))
+        readModel(fileName());
+    map()->freeze();
 }
 
 tMEM::~tMEM()
@@ -403,6 +656,114 @@ tMEM::readModel(const string &fileName)
     tdl_mode = saved_tdl_mode;
 }
 
+/** A hash of the names of all static types. Binary models store type codes,
+ *  this tells whether they are the codes of the grammar that is loaded.
+ */
+static int
+grammarFingerprint()
+{
+    unsigned int h = 2166136261u;
+    for(int t = 0; t < nstatictypes; ++t)
+    {
+        for(const char *c = type_name(t); *c != 0; ++c)
+        {
+            h ^= (unsigned char) *c;
+            h *= 16777619u;
+        }
+        h *= 16777619u;
+    }
+    return (int) h;
+}
+
+static void
+dump_double(dumper *f, double d)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    f->dump_int((int) (bits & 0xffffffffu));
+    f->dump_int((int) (bits >> 32));
+}
+
+static double
+undump_double(dumper *f)
+{
+    uint64_t bits = (uint32_t) f->undump_int();
+    bits |= ((uint64_t) (uint32_t) f->undump_int()) << 32;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+bool
+tMEM::readBinary(const string &fileName)
+{
+    dumper f(fileName.c_str());
+    try
+    {
+        if(f.undump_int() != SM_BINARY_MAGIC)
+            return false;
+    }
+    catch(tError &)
+    {
+        // too short for a binary model
+        return false;
+    }
+
+    int version = f.undump_int();
+    if(version != SM_BINARY_VERSION)
+    {
+        std::ostringstream msg;
+        msg << "binary model `" << fileName << "' has version " << version
+            << ", expected " << SM_BINARY_VERSION;
+        throw tError(msg.str());
+    }
+    int ntypes = f.undump_int();
+    int fingerprint = f.undump_int();
+    if(ntypes != nstatictypes || fingerprint != grammarFingerprint())
+        throw tError("binary model `" + fileName
+                     + "' was compiled for a different grammar");
+
+    _format = f.undump_int();
+    _gplevel = f.undump_int();
+    if(_gplevel >= 0)
+        set_opt("opt_gplevel", (unsigned int) _gplevel);
+    char *ctxts = f.undump_string();
+    _ctxts = string(ctxts != 0 ? ctxts : "");
+    delete[] ctxts;
+
+    map()->undump(&f);
+
+    int nFeatures = f.undump_int();
+    if(nFeatures < 0)
+        throw tError("corrupt binary model `" + fileName + "'");
+    _weights.resize(nFeatures);
+    for(int i = 0; i < nFeatures; ++i)
+        _weights[i] = undump_double(&f);
+
+    LOG(logAppl, INFO, "[" << nFeatures << " features, binary] ");
+    return true;
+}
+
+void
+tMEM::writeBinary(const string &fileName)
+{
+    dumper f(fileName.c_str(), true);
+    f.dump_int(SM_BINARY_MAGIC);
+    f.dump_int(SM_BINARY_VERSION);
+    f.dump_int(nstatictypes);
+    f.dump_int(grammarFingerprint());
+    f.dump_int(_format);
+    f.dump_int(_gplevel);
+    f.dump_string(_ctxts.c_str());
+
+    map()->dump(&f);
+
+    f.dump_int(_weights.size());
+    for(vector<double>::iterator it = _weights.begin();
+        it != _weights.end(); ++it)
+        dump_double(&f, *it);
+}
+
 void
 tMEM::parseModel()
 {
@@ -502,7 +863,8 @@ tMEM::parseOptions()
         if (LA(0)->tag == T_COLON) consume(1);
         pvalue = match(T_ID, "parameter value", false);
         match(T_DOT, "dot after parameter value", true);
-        set_opt("opt_gplevel", (unsigned int) atoi(pvalue));
+        _gplevel = atoi(pvalue);
+        set_opt("opt_gplevel", (unsigned int) _gplevel);
         free(pvalue);
       }
       else {
@@ -742,9 +1104,14 @@ tMEM::parseFeature2(int n)
 double
 tMEM::score(const tSMFeature &f)
 {
-    int code = map()->featureToCode(f);
-    assert(code >=0);
-    if(code < (int) _weights.size())
+    // features that are not in the model are not added to the map
+    return scoreCode(map()->findFeature(f));
+}
+
+double
+tMEM::scoreCode(int code)
+{
+    if(code >= 0 && code < (int) _weights.size())
         return _weights[code];
     else
         return 0.0;
@@ -1004,6 +1371,7 @@ tPCFG::tPCFG(class tGrammar *G, const char *fileNameIn, const char *basePath)
     _laplace_smoothing(1), _min_logprob(-1.0e+2)
 {
   readModel(fileName());
+  map()->freeze();
 }
 
 tPCFG::~tPCFG() {
@@ -1012,9 +1380,13 @@ tPCFG::~tPCFG() {
 double
 tPCFG::score(const tSMFeature &f)
 {
-  int code = map()->featureToCode(f);
-  assert(code >= 0);
-  if(code < (int) _weights.size())
+  return scoreCode(map()->findFeature(f));
+}
+
+double
+tPCFG::scoreCode(int code)
+{
+  if(code >= 0 && code < (int) _weights.size())
     return _weights[code];
   else
     return 1; // this will trigger smoothing in score(vector<type_t> )
@@ -1092,7 +1464,7 @@ tPCFG::scoreLeaf(class tLexItem *it) {
 }
 
 double
-tPCFG::score_hypothesis(struct tHypothesis* hypo, std::list<class tItem*> path, int gplevel) {
+tPCFG::score_hypothesis(struct tHypothesis* hypo, int path, int gplevel) {
   vector<type_t> r;
   double total = 0.0;
 
@@ -1101,16 +1473,13 @@ tPCFG::score_hypothesis(struct tHypothesis* hypo, std::list<class tItem*> path,
   else { // tPhrasalItem
     tPhrasalItem *phrase = (tPhrasalItem*)hypo->edge;
     r.push_back(phrase->identity());
-    list<tItem*> newpath = path;
-    newpath.push_back(hypo->edge);
-    if (newpath.size() > (unsigned)gplevel)
-      newpath.pop_front();
+    int newpath = tPathTable::extend(path, hypo->edge, gplevel);
     for (list<tHypothesis*>::iterator hypo_dtr = hypo->hypo_dtrs.begin();
          hypo_dtr != hypo->hypo_dtrs.end(); ++hypo_dtr) {
       r.push_back((*hypo_dtr)->edge->identity());
-      if ((*hypo_dtr)->scores.find(newpath) == (*hypo_dtr)->scores.end())
+      if (!(*hypo_dtr)->scored(newpath))
         score_hypothesis(*hypo_dtr, newpath, gplevel);
-      total = combineScores(total, (*hypo_dtr)->scores[newpath]);
+      total = combineScores(total, (*hypo_dtr)->score(newpath));
     }
 
 #if 0
@@ -1128,8 +1497,8 @@ tPCFG::score_hypothesis(struct tHypothesis* hypo, std::list<class tItem*> path,
 #endif
     total = combineScores(total, score(r));
   }
-  hypo->scores[path] = total;
-  return hypo->scores[path];
+  hypo->set_score(path, total);
+  return total;
 }
 
 void
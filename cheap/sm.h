@@ -48,6 +48,11 @@ class tSMFeature
 
     void
     print(std::ostream &) const;
+
+    /** Return the subfeatures of this feature */
+    const std::vector<int> &
+    subfeatures() const
+    { return _v; }
     
  private:
     std::vector<int> _v;
@@ -79,6 +84,11 @@ class tSM
     virtual double
     score(const tSMFeature &) = 0;
 
+    /** Compute score for the feature with code \a code in map(), -1 for a
+     *  feature that is not in the model. */
+    virtual double
+    scoreCode(int code) = 0;
+
     virtual double
     neutralScore() = 0;
 
@@ -98,10 +108,16 @@ class tSM
     virtual double
     scoreLeaf(class tLexItem *);
   
-    /** Return the score for the hypothesis */
+    /** Return the score for the hypothesis under the grandparenting path
+     *  \a path (an id from tPathTable) */
     virtual double 
-    score_hypothesis(struct tHypothesis* hypo, std::list<tItem*> path,
+    score_hypothesis(struct tHypothesis* hypo, int path,
                      unsigned int gplevel);
+
+    /** Return the score of the local features of the hypothesis (the ones
+     *  not scored by its daughters) under the grandparenting path \a path */
+    double
+    localScore(struct tHypothesis* hypo, int path, unsigned int gplevel);
     
     /** Return the best predicted lexical (entry) types for the given
      * context.
@@ -132,6 +148,11 @@ class tSM
  *  The model specifies features and their weights.
  *  A feature has the general form of a sequence of subfeatures. A subfeature
  *  is either a type / instance of the grammar, an integer, or a string.
+ *
+ *  The model is read either from its text form or from a binary form that
+ *  writeBinary() produces. The binary form holds the feature index and the
+ *  weights as they are in memory, with the type codes of the grammar it was
+ *  compiled for, so it has to be recompiled when the grammar changes.
  */
 class tMEM : public tSM
 {
@@ -145,6 +166,9 @@ class tMEM : public tSM
     virtual double
     score(const tSMFeature &);
 
+    virtual double
+    scoreCode(int code);
+
     virtual double
     neutralScore()
     { return 0.0 ; }
@@ -156,6 +180,10 @@ class tMEM : public tSM
     /** Return a description string suitable for printing.*/
     virtual std::string
     description();
+
+    /** Write the model in binary form to \a fileName */
+    void
+    writeBinary(const std::string &fileName);
     
 
  private:
@@ -173,9 +201,18 @@ class tMEM : public tSM
     */
     int _format;
 
+    /** The level of grandparenting the model sets, or -1 if it does not */
+    int _gplevel;
+
     void
     readModel(const std::string &fileName);
 
+    /** Read the model from \a fileName if it is a binary model.
+     *  \return \c false if it is not.
+     */
+    bool
+    readBinary(const std::string &fileName);
+
     void
     parseModel();
 
@@ -210,6 +247,9 @@ class tPCFG : public tSM
     virtual double
     score(const tSMFeature &);
 
+    virtual double
+    scoreCode(int code);
+
     virtual double
     neutralScore() // TODO: this should not be used
     { return 0.0; }
@@ -227,9 +267,10 @@ class tPCFG : public tSM
     virtual double
     scoreLeaf(class tLexItem *);
   
-    /** Return the score for the hypothesis */
+    /** Return the score for the hypothesis under the grandparenting path
+     *  \a path (an id from tPathTable) */
     virtual double 
-    score_hypothesis(struct tHypothesis* hypo, std::list<tItem*> path, int gplevel);
+    score_hypothesis(struct tHypothesis* hypo, int path, int gplevel);
     
 
  private:
@@ -26,6 +26,7 @@
 #include "tsdb++.h"
 #include "sm.h"
 #include "logging.h"
+#include "hashing.h"
 #include <iomanip>
 
 using namespace std;
@@ -33,12 +34,60 @@ using namespace std;
 // defined in parse.cpp
 extern bool opt_hyper;
 extern int  opt_packing;
+extern int  opt_fail_cache;
 
 int basic_task::next_id = 0;
 
+extern tAbstractAgenda *Agenda;
+
+pool_allocator *task_pool() {
+  return (Agenda != NULL) ? &Agenda->pool() : NULL;
+}
+
+/** Key of the unification failure cache: a rule, the argument position that
+ *  is filled, and the fingerprint of the daughter.
+ */
+struct fail_key {
+  int rule;
+  int arg;
+  unsigned long long daughter;
+
+  bool operator==(const fail_key &k) const {
+    return rule == k.rule && arg == k.arg && daughter == k.daughter;
+  }
+};
+
+struct fail_key_hash {
+  inline size_t operator()(const fail_key &k) const {
+    return (size_t) (k.daughter ^ (k.daughter >> 32))
+      ^ (size_t) (k.rule * 8 + k.arg);
+  }
+};
+
+/** Failed applications of rules to passive items, kept across items (when
+ *  opt_fail_cache > 0). Whether the unification fails only depends on the
+ *  rule and the daughter feature structure, so a repeated combination can be
+ *  rejected without unifying. The cache is emptied when it grows beyond
+ *  opt_fail_cache entries.
+ */
+static HASH_SPACE::hash_set<fail_key, fail_key_hash> fail_cache;
+
 tItem *
 build_rule_item(chart *C, tAbstractAgenda *A, grammar_rule *R, tItem *passive)
 {
+    fail_key key;
+    if(opt_fail_cache > 0)
+    {
+        key.rule = R->id();
+        key.arg = R->nextarg();
+        key.daughter = passive->fingerprint();
+        if(fail_cache.find(key) != fail_cache.end())
+        {
+            stats.fcache_hits++;
+            return 0;
+        }
+    }
+
     fs_alloc_state FSAS(false);
     
     stats.etasks++;
@@ -77,6 +126,13 @@ build_rule_item(chart *C, tAbstractAgenda *A, grammar_rule *R, tItem *passive)
     if(!res.valid())
     {
         FSAS.release();
+        if(opt_fail_cache > 0)
+        {
+            if(fail_cache.size() >= (size_t) opt_fail_cache)
+                fail_cache.clear();
+            fail_cache.insert(key);
+            stats.fcache_adds++;
+        }
         return 0;
     }
     else
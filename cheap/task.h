@@ -26,19 +26,29 @@
 #define _TASK_H_
 
 #include "agenda.h"
+#include "pool-alloc.h"
 #include <functional>
 #include <iosfwd>
 
 /** Parser agenda: a queue of prioritized tasks */
-typedef abstract_agenda< class basic_task, class task_priority_less > tAbstractAgenda;
-typedef exhaustive_agenda< class basic_task, class task_priority_less > tExhaustiveAgenda;
-typedef local_cap_agenda< class basic_task, class task_priority_less > tLocalCapAgenda;
+typedef abstract_agenda< class basic_task > tAbstractAgenda;
+typedef exhaustive_agenda< class basic_task > tExhaustiveAgenda;
+typedef local_cap_agenda< class basic_task > tLocalCapAgenda;
+typedef wavefront_agenda< class basic_task > tWavefrontAgenda;
+
+/** The arena of the current parser agenda, where new tasks are allocated,
+ *  or \c NULL if there is no agenda and the system heap is used.
+ */
+pool_allocator *task_pool();
 
 /** Pure virtual base class for tasks */
 class basic_task {
 public:
   virtual ~basic_task() {}
 
+  // tasks are taken from the arena of the current agenda
+  POOL_ALLOCATED(task_pool())
+
   /** ID counter to produce unique task ids */
   static int next_id;
 
@@ -85,8 +95,6 @@ protected:
   
   /** The priority of this task */
   double _p;
-    
-  friend class task_priority_less;
 };
 
 /** Combination of grammar rule and passive item */
@@ -147,19 +155,6 @@ class active_and_passive_task : public basic_task
     class tItem *_passive;
 };
 
-/** Comparison predicate for tasks based on their priority */
-class task_priority_less 
-  : public std::binary_function<basic_task *, basic_task *, bool>
-{
- public:
-    /** \a x is less than \a y if \a x's priority is less than \a y's */
-    inline bool
-    operator() (const basic_task* x, const basic_task* y) const
-    {
-        return x->priority() < y->priority();
-    }
-};
-
 inline std::ostream & operator<<(std::ostream &out, basic_task *t) {
   t->print(out); return out;
 }
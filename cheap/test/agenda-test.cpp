@@ -0,0 +1,158 @@
+/* PET
+ * Platform for Experimentation with efficient HPSG processing Techniques
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file agenda-test.cpp
+ * Unit tests for the task heap of the agendas.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <set>
+#include <vector>
+#include "task.h"
+
+using namespace std;
+
+/** Stand-in for a task, only the priority matters to the heap */
+struct tFakeTask {
+  double p;
+  tFakeTask(double prio) : p(prio) {}
+};
+
+struct tFakeTaskLess {
+  bool operator()(const tFakeTask *x, const tFakeTask *y) const {
+    return x->p < y->p;
+  }
+};
+
+class tTaskHeapTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(tTaskHeapTest);
+  CPPUNIT_TEST(test_order);
+  CPPUNIT_TEST(test_ties);
+  CPPUNIT_TEST(test_interleaved);
+  CPPUNIT_TEST(test_key_less);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  vector<tFakeTask *> _tasks;
+
+  /** Make \a n tasks with priorities from 0 to \a distinct - 1 */
+  void make_tasks(int n, int distinct) {
+    for(int i = 0; i < n; ++i)
+      _tasks.push_back(new tFakeTask(rand() % distinct));
+  }
+
+public:
+  void setUp() {
+    srand(4711);
+  }
+
+  void tearDown() {
+    for(size_t i = 0; i < _tasks.size(); ++i)
+      delete _tasks[i];
+    _tasks.clear();
+  }
+
+  /** The priorities come out in the same order as from std::priority_queue */
+  void test_order() {
+    make_tasks(1000, 1000);
+    task_heap<tFakeTask, double> heap;
+    priority_queue<double> reference;
+    for(size_t i = 0; i < _tasks.size(); ++i) {
+      heap.push(_tasks[i]->p, _tasks[i]);
+      reference.push(_tasks[i]->p);
+    }
+    while(! reference.empty()) {
+      CPPUNIT_ASSERT(! heap.empty());
+      CPPUNIT_ASSERT_EQUAL(reference.top(), heap.top()->p);
+      reference.pop();
+      heap.pop();
+    }
+    CPPUNIT_ASSERT(heap.empty());
+  }
+
+  /** Neither heap defines an order among tasks with the same priority, but
+   *  every run of equal priorities has to hand out the same set of tasks.
+   */
+  void test_ties() {
+    make_tasks(1000, 8);
+    task_heap<tFakeTask, double> heap;
+    priority_queue<tFakeTask *, vector<tFakeTask *>, tFakeTaskLess> reference;
+    for(size_t i = 0; i < _tasks.size(); ++i) {
+      heap.push(_tasks[i]->p, _tasks[i]);
+      reference.push(_tasks[i]);
+    }
+    while(! reference.empty()) {
+      double p = reference.top()->p;
+      set<tFakeTask *> expected, got;
+      while(! reference.empty() && reference.top()->p == p) {
+        expected.insert(reference.top());
+        reference.pop();
+      }
+      while(! heap.empty() && heap.top()->p == p) {
+        got.insert(heap.top());
+        heap.pop();
+      }
+      CPPUNIT_ASSERT(expected == got);
+    }
+    CPPUNIT_ASSERT(heap.empty());
+  }
+
+  /** Pushing while popping, as the parser does */
+  void test_interleaved() {
+    make_tasks(2000, 50);
+    task_heap<tFakeTask, double> heap;
+    priority_queue<double> reference;
+    size_t next = 0;
+    while(next < _tasks.size() || ! reference.empty()) {
+      for(int k = rand() % 4; k >= 0 && next < _tasks.size(); --k, ++next) {
+        heap.push(_tasks[next]->p, _tasks[next]);
+        reference.push(_tasks[next]->p);
+      }
+      if(! reference.empty()) {
+        CPPUNIT_ASSERT_EQUAL(reference.top(), heap.top()->p);
+        reference.pop();
+        heap.pop();
+      }
+    }
+    CPPUNIT_ASSERT(heap.empty());
+  }
+
+  /** The key comparison is taken from the template argument */
+  void test_key_less() {
+    make_tasks(500, 100);
+    task_heap<tFakeTask, double, greater<double> > heap;
+    priority_queue<double, vector<double>, greater<double> > reference;
+    for(size_t i = 0; i < _tasks.size(); ++i) {
+      heap.push(_tasks[i]->p, _tasks[i]);
+      reference.push(_tasks[i]->p);
+    }
+    while(! reference.empty()) {
+      CPPUNIT_ASSERT_EQUAL(reference.top(), heap.top()->p);
+      reference.pop();
+      heap.pop();
+    }
+    CPPUNIT_ASSERT(heap.empty());
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(tTaskHeapTest);
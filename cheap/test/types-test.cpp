@@ -33,6 +33,7 @@ class tTypesTest : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE(tTypesTest);
   CPPUNIT_TEST(test_dyntypes);
+  CPPUNIT_TEST(test_subtype_index);
   CPPUNIT_TEST_SUITE_END();
   
 private:
@@ -119,6 +120,38 @@ public:
     type_t t3 = retrieve_string_instance(i);
     CPPUNIT_ASSERT(lookup_type("\"42\"") == t3);
   }
+
+  /** Reference implementation of subtype() for static types, following the
+   *  leaf type chain and comparing bitcodes.
+   */
+  static bool reference_subtype(type_t a, type_t b)
+  {
+    if(a == b || b == BI_TOP) return true;
+    while(is_leaftype(a)) {
+      a = leaftype_parent(a);
+      if(a == b) return true;
+    }
+    if(is_leaftype(b)) return false;
+    return core_subtype(a, b);
+  }
+
+  void test_subtype_index()
+  {
+    int n = (nstatictypes < 1000) ? nstatictypes : 1000;
+    for(type_t a = 0; a < n; ++a) {
+      type_t ta = (a % 2) ? a : nstatictypes - 1 - a;
+      for(type_t b = 0; b < n; ++b) {
+        type_t tb = (b % 2) ? b : nstatictypes - 1 - b;
+        CPPUNIT_ASSERT(subtype(ta, tb) == reference_subtype(ta, tb));
+        if(ta != tb) {
+          bool forward, backward;
+          subtype_bidir(ta, tb, forward, backward);
+          CPPUNIT_ASSERT(forward == reference_subtype(ta, tb));
+          CPPUNIT_ASSERT(backward == reference_subtype(tb, ta));
+        }
+      }
+    }
+  }
     
 };
 
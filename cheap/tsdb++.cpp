@@ -98,6 +98,8 @@ statistics::reset()
   nmeanings = 0;
   unify_cost_succ = 0;
   unify_cost_fail = 0;
+  fcache_hits = 0;
+  fcache_adds = 0;
 
   p_equivalent = 0;
   p_proactive = 0;
@@ -137,6 +139,7 @@ statistics::print(FILE *f)
            "p_dyn_bytes: %lld\np_stat_bytes: %lld\n"
            "cycles: %d\nfssize: %d\n"
            "unify_cost_succ: %d\nunify_cost_fail: %d\n"
+           "fcache_hits: %d\nfcache_adds: %d\n"
            "equivalent: %d\nproactive: %d\nretroactive: %d\n"
            "frozen: %d\nfailures: %d\nhypotheses: %d\n",
            id, trees, rtrees, readings, rreadings,
@@ -154,6 +157,7 @@ statistics::print(FILE *f)
            p_dyn_bytes, p_stat_bytes,
            cycles, fssize,
            unify_cost_succ, unify_cost_fail,
+           fcache_hits, fcache_adds,
            p_equivalent, p_proactive, p_retroactive,
            p_frozen, p_failures, p_hypotheses
            );
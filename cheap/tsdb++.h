@@ -132,6 +132,10 @@ class statistics
   int unify_cost_succ;
   /** costs for all failing unifications */
   int unify_cost_fail;
+  /** rule applications rejected by the unification failure cache */
+  int fcache_hits;
+  /** failed rule applications added to the unification failure cache */
+  int fcache_adds;
 
   /** @name Slots For Packing */
   /*@{*/
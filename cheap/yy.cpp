@@ -52,6 +52,10 @@
 #include "tsdb++.h"
 #include "yy.h"
 #include "configs.h"
+#include "fs.h"
+
+#include <fstream>
+#include <set>
 #ifdef HAVE_ICU
 #include "unicode.h"
 #define massageUTF8(str) Conv->convert(ConvUTF8->convert(str))
@@ -114,6 +118,17 @@ int cheap_server_initialize(int port) {
       log != _log_channels.end();
       ++log)
     install_socket_logger(*log);
+
+  //
+  // the server changes to /tmp below, so a relative warm-up file has to be
+  // resolved against the directory cheap was started in beforehand
+  //
+  string warmup = get_opt_string("opt_server_warmup");
+  if(!warmup.empty() && warmup[0] != '/') {
+    char cwd[MAXPATHLEN];
+    if(getcwd(cwd, sizeof(cwd)) != NULL)
+      set_opt("opt_server_warmup", string(cwd) + "/" + warmup);
+  } /* if */
   
 #if !defined(FOREGROUND)
 
@@ -204,14 +219,14 @@ int cheap_server_initialize(int port) {
 
 } /* cheap_server_initialize() */
 
-void cheap_server(int port) {
+/** Create the listening socket of the server, bound to \a port */
+static int cheap_server_socket(int port) {
 
-  int server, client;
+  int server;
 
   unsigned int n;
-  struct sockaddr_in server_address, client_address;
+  struct sockaddr_in server_address;
   struct linger linger;
-  struct hostent *host;
 
   if((server = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
     throw tError("unable to create server socket.");
@@ -243,55 +258,242 @@ void cheap_server(int port) {
 
   listen(server, SOMAXCONN);
 
+  return server;
+
+} /* cheap_server_socket() */
+
 #if defined(__CYGWIN__)
 #  define socklen_t int
 #endif
 
-  while(true) {
-    n = sizeof(client_address);
-    if((client = accept(server,
-                        (struct sockaddr *)&client_address,
-                        (socklen_t *)&n)) < 0) {
+/** Wait for the next client on \a server.
+ *  \return the client socket, or -1 if accept(2) failed
+ */
+static int cheap_server_accept(int server) {
+
+  int client;
+
+  unsigned int n;
+  struct sockaddr_in client_address;
+  struct linger linger;
+  struct hostent *host;
+
+  n = sizeof(client_address);
+  if((client = accept(server,
+                      (struct sockaddr *)&client_address,
+                      (socklen_t *)&n)) < 0) {
+
+    for(list<FILE *>::iterator log = _log_channels.begin();
+        log != _log_channels.end();
+        ++log) {
+      fprintf(*log,
+              "[%d] server(): failed (invalid) accept(2) [%d].\n",
+              getpid(), errno);
+      fflush(*log);
+    } /* for */
+    return -1;
+  } /* if */
+
+  for(list<FILE *>::iterator log = _log_channels.begin();
+      log != _log_channels.end();
+      ++log) {
+    if((host = gethostbyaddr((char *)&client_address.sin_addr.s_addr,
+                             4, AF_INET)) != NULL
+       && host->h_name != NULL) {
+      fprintf(*log,
+              "[%d] server(): connect from `%s' (%s).\n",
+              getpid(), host->h_name, current_time().c_str());
+    } /* if */
+    else {
+      char *address = inet_ntoa(client_address.sin_addr);
+      fprintf(*log,
+              "[%d] server(): connect from `%s' (%s) .\n",
+              getpid(),
+              (address != NULL ? address : "?.?.?.?"),
+              current_time().c_str());
+    } /* else */
+    fflush(*log);
+  } /* for */
+
+  n = 1;
+  setsockopt(client, SOL_SOCKET, SO_KEEPALIVE, (char *)&n, sizeof(n));
+  setsockopt(client, SOL_SOCKET, SO_REUSEADDR, (char *)&n, sizeof(n));
+  linger.l_onoff = 1;
+  linger.l_linger = 2;
+  setsockopt(client, SOL_SOCKET, SO_LINGER,
+             (char *)&linger, sizeof(linger));
+
+  return client;
+
+} /* cheap_server_accept() */
+
+/** The peak resident set size of this process, in kilobytes */
+static long cheap_server_maxrss() {
+
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return usage.ru_maxrss;
+
+} /* cheap_server_maxrss() */
+
+/** Parse the sentences in the file named by `opt_server_warmup', such that
+ *  the type and constraint caches are populated before the children are
+ *  forked and shared by all of them.
+ */
+static void cheap_server_warmup() {
+
+  string file = get_opt_string("opt_server_warmup");
+  if(file.empty()) return;
+
+  ifstream in(file.c_str());
+  if(!in) {
+    for(list<FILE *>::iterator log = _log_channels.begin();
+        log != _log_channels.end();
+        ++log) {
+      fprintf(*log,
+              "[%d] server(): unable to open warm-up file `%s'.\n",
+              getpid(), file.c_str());
+      fflush(*log);
+    } /* for */
+    return;
+  } /* if */
+
+  int nitems = 0;
+  string input;
+  while(getline(in, input)) {
+    if(input.empty()) continue;
+    fs_alloc_state FSAS;
+    chart *Chart = 0;
+    list<tError> errors;
+    try {
+      analyze(input, Chart, FSAS, errors, ++nitems);
+    } /* try */
+    catch(tError &e) {
+      // failures do not matter here, the caches are filled anyway
+    } /* catch */
+    if(Chart != 0) delete Chart;
+  } /* while */
 
+  for(list<FILE *>::iterator log = _log_channels.begin();
+      log != _log_channels.end();
+      ++log) {
+    fprintf(*log,
+            "[%d] server(): warmed up with %d item(s) (%s).\n",
+            getpid(), nitems, current_time().c_str());
+    fflush(*log);
+  } /* for */
+
+} /* cheap_server_warmup() */
+
+/** The main loop of a pre-forked child: serve clients from the shared socket
+ *  \a server until `opt_server_recycle' items have been processed or the
+ *  process has grown by more than `opt_server_recycle_mem' megabytes.
+ */
+static void cheap_server_prefork_child(int server) {
+
+  int maxitems = get_opt_int("opt_server_recycle");
+  long maxgrowth = get_opt_int("opt_server_recycle_mem") * 1024L;
+  long baseline = cheap_server_maxrss();
+  int nitems = 0;
+
+  while(maxitems <= 0 || nitems < maxitems) {
+    int client = cheap_server_accept(server);
+    if(client < 0) continue;
+    nitems += cheap_server_child(client);
+    if(maxgrowth > 0 && cheap_server_maxrss() - baseline > maxgrowth) {
       for(list<FILE *>::iterator log = _log_channels.begin();
           log != _log_channels.end();
           ++log) {
         fprintf(*log,
-                "[%d] server(): failed (invalid) accept(2) [%d].\n",
-                getpid(), errno);
+                "[%d] server_child(): recycling after %ldK growth.\n",
+                getpid(), cheap_server_maxrss() - baseline);
         fflush(*log);
       } /* for */
-      continue;
+      break;
     } /* if */
+  } /* while */
 
-    for(list<FILE *>::iterator log = _log_channels.begin();
-        log != _log_channels.end();
-        ++log) {
-      if((host = gethostbyaddr((char *)&client_address.sin_addr.s_addr,
-                               4, AF_INET)) != NULL
-         && host->h_name != NULL) {
-        fprintf(*log,
-                "[%d] server(): connect from `%s' (%s).\n",
-                getpid(), host->h_name, current_time().c_str());
+  close(server);
+  exit(0);
+
+} /* cheap_server_prefork_child() */
+
+/** Keep a pool of \a nchildren pre-forked children accepting clients on
+ *  \a server, and replace every child that exits.
+ */
+static void cheap_server_prefork(int server, int nchildren) {
+
+  cheap_server_warmup();
+
+  //
+  // the children are reaped below, where they can be replaced; _sigchld()
+  // would take their exit status away from waitpid(2)
+  //
+#if defined(SIGCHLD)
+  signal(SIGCHLD, SIG_DFL);
+#endif
+
+  set<int> children;
+  while(true) {
+    while((int)children.size() < nchildren) {
+      int child;
+      if((child = fork()) < 0) {
+        for(list<FILE *>::iterator log = _log_channels.begin();
+            log != _log_channels.end();
+            ++log) {
+          fprintf(*log,
+                  "[%d] server(): unable to fork(2) child [%d].\n",
+                  getpid(), errno);
+          fflush(*log);
+        } /* for */
+        sleep(1);
+        break;
       } /* if */
-      else {
-        char *address = inet_ntoa(client_address.sin_addr);
-        fprintf(*log,
-                "[%d] server(): connect from `%s' (%s) .\n",
-                getpid(),
-                (address != NULL ? address : "?.?.?.?"),
-                current_time().c_str());
-      } /* else */
-      fflush(*log);
-    } /* for */
+      else if(child == 0) {
+        cheap_server_prefork_child(server);
+      } /* if */
+      children.insert(child);
+    } /* while */
+
+    int status, pid;
+    if((pid = waitpid(-1, &status, 0)) < 0) {
+      if(errno == ECHILD) children.clear();
+      continue;
+    } /* if */
+    else {
+      children.erase(pid);
+      for(list<FILE *>::iterator log = _log_channels.begin();
+          log != _log_channels.end();
+          ++log) {
+        if(WIFEXITED(status))
+          fprintf(*log,
+                  "[%d] server(): relieved child # %d (exit: %d).\n",
+                  getpid(), pid, WEXITSTATUS(status));
+        else if(WIFSIGNALED(status))
+          fprintf(*log,
+                  "[%d] server(): relieved child # %d (signal: %d).\n",
+                  getpid(), pid, WTERMSIG(status));
+        fflush(*log);
+      } /* for */
+    } /* if */
+  } /* while */
 
-    n = 1;
-    setsockopt(client, SOL_SOCKET, SO_KEEPALIVE, (char *)&n, sizeof(n));
-    setsockopt(client, SOL_SOCKET, SO_REUSEADDR, (char *)&n, sizeof(n));
-    linger.l_onoff = 1;
-    linger.l_linger = 2;
-    setsockopt(client, SOL_SOCKET, SO_LINGER,
-               (char *)&linger, sizeof(linger));
+} /* cheap_server_prefork() */
+
+void cheap_server(int port) {
+
+  int server, client;
+
+  server = cheap_server_socket(port);
+
+  int nchildren = get_opt_int("opt_server_prefork");
+  if(nchildren > 0) {
+    cheap_server_prefork(server, nchildren);
+    return;
+  } /* if */
+
+  while(true) {
+    if((client = cheap_server_accept(server)) < 0) continue;
 
 #if defined(NOFORK)
     if(!cheap_server_child(client)) {
@@ -316,7 +518,7 @@ void cheap_server(int port) {
   } /* while */
 
 } /* cheap_server() */
-
+
 int cheap_server_child(int socket) {
 
   int ntsdbitems = 1;
@@ -24,6 +24,131 @@
 #include "dumper.h"
 #include "errors.h"
 
+// Vectorized kernels for the operations on the glb computation path. They
+// are compiled for SSE2 and AVX2 independent of the compiler flags, and
+// selected at runtime depending on what the CPU supports.
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) \
+  && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_BITCODE_SIMD)
+#define BITCODE_SIMD
+#include <immintrin.h>
+#endif
+
+#ifdef BITCODE_SIMD
+
+enum simd_level { SIMD_UNKNOWN = -1, SIMD_NONE, SIMD_SSE2, SIMD_AVX2 };
+
+static simd_level
+cpu_simd_level()
+{
+  static simd_level level = SIMD_UNKNOWN;
+  if(level == SIMD_UNKNOWN)
+    {
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx2"))
+        level = SIMD_AVX2;
+      else if(__builtin_cpu_supports("sse2"))
+        level = SIMD_SSE2;
+      else
+        level = SIMD_NONE;
+    }
+  return level;
+}
+
+/* C = A & B for n words, return true if C is all zero */
+__attribute__((target("avx2"))) static bool
+intersect_empty_avx2(const CODEWORD *a, const CODEWORD *b, CODEWORD *c, int n)
+{
+  __m256i acc = _mm256_setzero_si256();
+  int i = 0;
+  for(; i + 8 <= n; i += 8)
+    {
+      __m256i r = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) (a + i)),
+                                   _mm256_loadu_si256((const __m256i *) (b + i)));
+      _mm256_storeu_si256((__m256i *) (c + i), r);
+      acc = _mm256_or_si256(acc, r);
+    }
+  CODEWORD rest = 0;
+  for(; i < n; ++i)
+    rest |= (c[i] = a[i] & b[i]);
+  return _mm256_testz_si256(acc, acc) && rest == 0;
+}
+
+__attribute__((target("sse2"))) static bool
+intersect_empty_sse2(const CODEWORD *a, const CODEWORD *b, CODEWORD *c, int n)
+{
+  __m128i acc = _mm_setzero_si128();
+  int i = 0;
+  for(; i + 4 <= n; i += 4)
+    {
+      __m128i r = _mm_and_si128(_mm_loadu_si128((const __m128i *) (a + i)),
+                                _mm_loadu_si128((const __m128i *) (b + i)));
+      _mm_storeu_si128((__m128i *) (c + i), r);
+      acc = _mm_or_si128(acc, r);
+    }
+  CODEWORD rest = 0;
+  for(; i < n; ++i)
+    rest |= (c[i] = a[i] & b[i]);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) == 0xffff
+    && rest == 0;
+}
+
+/* is a a subset of b (n words)? */
+__attribute__((target("avx2"))) static bool
+subset_avx2(const CODEWORD *a, const CODEWORD *b, int n)
+{
+  int i = 0;
+  for(; i + 8 <= n; i += 8)
+    {
+      // testc: (~b & a) == 0
+      if(!_mm256_testc_si256(_mm256_loadu_si256((const __m256i *) (b + i)),
+                             _mm256_loadu_si256((const __m256i *) (a + i))))
+        return false;
+    }
+  for(; i < n; ++i)
+    if((a[i] & b[i]) != a[i]) return false;
+  return true;
+}
+
+__attribute__((target("sse2"))) static bool
+subset_sse2(const CODEWORD *a, const CODEWORD *b, int n)
+{
+  int i = 0;
+  for(; i + 4 <= n; i += 4)
+    {
+      __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+      __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+      __m128i diff = _mm_andnot_si128(vb, va);
+      if(_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xffff)
+        return false;
+    }
+  for(; i < n; ++i)
+    if((a[i] & b[i]) != a[i]) return false;
+  return true;
+}
+
+/* fwd = a subset of b, bwd = b subset of a (n words) */
+__attribute__((target("avx2"))) static void
+subset_bidir_avx2(const CODEWORD *a, const CODEWORD *b, int n,
+                  bool &fwd, bool &bwd)
+{
+  int i = 0;
+  for(; i + 8 <= n && (fwd || bwd); i += 8)
+    {
+      __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+      __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+      if(fwd && !_mm256_testc_si256(vb, va)) fwd = false;
+      if(bwd && !_mm256_testc_si256(va, vb)) bwd = false;
+    }
+  for(; i < n && (fwd || bwd); ++i)
+    {
+      CODEWORD join = a[i] & b[i];
+      if(join != a[i]) fwd = false;
+      if(join != b[i]) bwd = false;
+    }
+}
+
+#endif
+
 bitcode::bitcode(int n)
 {
   sz = n;
@@ -120,6 +245,14 @@ subset_bidir(const bitcode&A, const bitcode &B, bool &a, bool &b)
     CODEWORD *cA, *cB;
     a = b = true;
 
+#ifdef BITCODE_SIMD
+    if(cpu_simd_level() == SIMD_AVX2)
+      {
+        subset_bidir_avx2(A.V, B.V, A.end() - A.V, a, b);
+        return;
+      }
+#endif
+
     for(cA = A.V, cB = B.V; cA < A.end(); ++cA, ++cB)
     {
         CODEWORD join = *cA & *cB;
@@ -136,6 +269,18 @@ bool intersect_empty(const bitcode &A, const bitcode &B, bitcode *C)
   CODEWORD *p, *q, *s;
   bool empty;
 
+#ifdef BITCODE_SIMD
+  switch(cpu_simd_level())
+    {
+    case SIMD_AVX2:
+      return intersect_empty_avx2(A.V, B.V, C->V, A.end() - A.V);
+    case SIMD_SSE2:
+      return intersect_empty_sse2(A.V, B.V, C->V, A.end() - A.V);
+    default:
+      break;
+    }
+#endif
+
   for(p = A.V, q = B.V, s = C->V, empty = true; p < A.end(); ++p, ++q, ++s)
     if((*s = *p & *q) != 0) empty = false;
 
@@ -147,6 +292,18 @@ bool bitcode::subset(const bitcode &supposed_superset)
   assert(sz == supposed_superset.sz);
   CODEWORD *sub, *super;
 
+#ifdef BITCODE_SIMD
+  switch(cpu_simd_level())
+    {
+    case SIMD_AVX2:
+      return subset_avx2(V, supposed_superset.V, end() - V);
+    case SIMD_SSE2:
+      return subset_sse2(V, supposed_superset.V, end() - V);
+    default:
+      break;
+    }
+#endif
+
   for(sub = V, super = supposed_superset.V; sub < end(); ++sub, ++super)
     if((*sub & *super) != *sub) return false;
 
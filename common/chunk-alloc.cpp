@@ -34,6 +34,8 @@
 #include "chunk-alloc.h"
 #include "errors.h"
 
+#include <algorithm>
+
 chunk_allocator t_alloc(CHUNK_SIZE, false);
 chunk_allocator p_alloc(CHUNK_SIZE, true);
 
@@ -123,6 +125,18 @@ void chunk_allocator::reset() {
   may_shrink();
 }
 
+void chunk_allocator::swap(chunk_allocator &other) {
+  std::swap(_chunk_pos, other._chunk_pos);
+  std::swap(_chunk_size, other._chunk_size);
+  std::swap(_curr_chunk, other._curr_chunk);
+  std::swap(_nchunks, other._nchunks);
+  std::swap(_chunk, other._chunk);
+  std::swap(_max, other._max);
+  std::swap(_stats_chunk_sum, other._stats_chunk_sum);
+  std::swap(_stats_chunk_n, other._stats_chunk_n);
+  std::swap(_core_down, other._core_down);
+}
+
 void chunk_allocator::print_check() {
   for (int i=0; i < _nchunks; ++i) {
     printf("alloc'ed: [%x %x]\n", (ptr2uint_t) _chunk[i]
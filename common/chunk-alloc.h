@@ -140,6 +140,12 @@ class chunk_allocator
 
   void print_check() ;
 
+  /** Exchange the complete state (chunks, positions and statistics) of this
+   *  allocator with that of \a other. This is what allows a parse context to
+   *  bring its own temporary heap into \c t_alloc and to take it out again.
+   */
+  void swap(chunk_allocator &other);
+
  private:
 
   /** number of bytes allocated in current chunk */
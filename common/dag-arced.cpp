@@ -228,6 +228,53 @@ int dag_size(dag_node *dag)
   return nodes;
 }
 
+/** FNV-1a style mixing of \a val into \a hash */
+static inline void
+fingerprint_mix(unsigned long long &hash, unsigned int val)
+{
+  hash = (hash ^ val) * 1099511628211ULL;
+}
+
+static void
+dag_fingerprint_rec(dag_node *dag, unsigned long long &hash, int &nodes,
+                    const list_int *anonymous, bool anonymize)
+{
+  dag = dag_deref(dag);
+
+  int id = dag_get_visit(dag);
+  if(id != 0)
+    { // coreference: refer to the number of the node visited before
+      fingerprint_mix(hash, 0x80000000U | id);
+      return;
+    }
+  dag_set_visit(dag, ++nodes);
+
+  type_t type = dag_type(dag);
+#ifdef DYNAMIC_SYMBOLS
+  if(anonymize && is_dynamic_type(type))
+    type = BI_STRING;
+#endif
+  fingerprint_mix(hash, type);
+  for(dag_arc *arc = dag->arcs; arc != 0; arc = arc->next)
+    {
+      fingerprint_mix(hash, 0x40000000U | arc->attr);
+      dag_fingerprint_rec(arc->val, hash, nodes, anonymous,
+                          anonymous != 0 && contains(anonymous, arc->attr));
+    }
+  // mark the end of the arc list
+  fingerprint_mix(hash, 0x20000000U);
+}
+
+unsigned long long dag_fingerprint(dag_node *dag, const list_int *anonymous)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  if(dag == 0 || dag == FAIL) return hash;
+  int nodes = 0;
+  dag_fingerprint_rec(dag, hash, nodes, anonymous, false);
+  dag_invalidate_visited();
+  return hash;
+}
+
 dag_node *dag_listify_ints(list_int *types)
 // builds list in reverse order
 {
@@ -267,6 +267,14 @@ void dag_print(FILE *f, dag_node *dag);
 /** Return the dag size in number of nodes */
 int dag_size(dag_node *dag);
 
+/** Return a 64 bit hash of the structure of \a dag: its types, attributes
+ *  and coreferences. Structurally equal dags whose arcs are stored in the same
+ *  order get the same fingerprint. String instances that are values of one
+ *  of the attributes in \a anonymous are all hashed alike.
+ */
+unsigned long long dag_fingerprint(dag_node *dag,
+                                   const list_int *anonymous = 0);
+
 /** Destructively remove all arcs emerging from \a dag that bear an attribute
  *  present in the \a del list
  */
@@ -36,6 +36,8 @@
 #endif
 
 #include <cassert>
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 using namespace HASH_SPACE;
@@ -49,6 +51,34 @@ static hash_map<bitcode, int> codetable;
 static bitcode *temp_bitcode = NULL;
 static int codesize;
 
+#ifndef FLOP
+/** Row displacement table of the glbs of all proper types, or \c NULL if
+ *  the grammar file does not contain one.
+ * The glb of proper types a < b is found at glbtable[2 * (glbtable_base[a] +
+ * b) + 1] if glbtable[2 * (glbtable_base[a] + b)] == a, and is bottom
+ * otherwise.
+ */
+static int *glbtable_base = 0;
+static int *glbtable = 0;
+
+/** Constant time subtype index, see initialize_subtype_index().
+ * Row \c a of \c subtype_rows has a bit set for every proper supertype of
+ * the proper type \c a; it is \c NULL if the index for proper types could
+ * not be built. Leaf types are mapped to their first proper ancestor, and
+ * carry a pre/post order interval over the forest of leaf types.
+ */
+static unsigned int *subtype_rows = 0;
+static int subtype_stride = 0;
+static type_t *leaftype_proper = 0;
+static int *leaftype_pre = 0;
+static int *leaftype_post = 0;
+
+/** Don't build the proper type part of the subtype index for hierarchies
+ *  larger than this, it needs (n * n / 8) bytes.
+ */
+#define SUBTYPE_INDEX_MAX_TYPES 16384
+#endif
+
 type_t *apptype = 0;
 type_t *maxapp = 0;
 
@@ -330,6 +360,18 @@ void free_type_tables()
 
   delete temp_bitcode;
   delete[] leaftypeparent;
+  delete[] glbtable_base;
+  glbtable_base = 0;
+  delete[] glbtable;
+  glbtable = 0;
+  delete[] subtype_rows;
+  subtype_rows = 0;
+  delete[] leaftype_proper;
+  leaftype_proper = 0;
+  delete[] leaftype_pre;
+  leaftype_pre = 0;
+  delete[] leaftype_post;
+  leaftype_post = 0;
   delete[] apptype;
   delete[] maxapp;
   delete[] featset;
@@ -362,6 +404,72 @@ void dump_hierarchy(dumper *f)
   }
 }
 
+int core_glb(int a, int b);
+
+void dump_glbtable(dumper *f)
+{
+  // compute the non-bottom glbs of all pairs of proper types a < b (in cheap
+  // order) row by row
+  vector< vector< pair<int, int> > > rows(first_leaftype);
+  int ncells = 0;
+  for(int a = 0; a < first_leaftype; ++a) {
+    for(int b = a + 1; b < first_leaftype; ++b) {
+      int g = core_glb(cheap2flop[a], cheap2flop[b]);
+      if(g != T_BOTTOM) {
+        rows[a].push_back(make_pair(b, flop2cheap[g]));
+        ++ncells;
+      }
+    }
+  }
+
+  // most rows are almost empty, so overlay them with row displacement: a
+  // cell at column b of row a lives at base[a] + b and is owned by row a
+  // only if its check entry says so. Place the fullest rows first.
+  vector< pair<int, int> > order;
+  for(int a = 0; a < first_leaftype; ++a)
+    order.push_back(make_pair(-(int) rows[a].size(), a));
+  sort(order.begin(), order.end());
+
+  vector<int> base(first_leaftype, 0);
+  vector<int> check(first_leaftype, -1), value(first_leaftype, T_BOTTOM);
+  int firstfree = 0;
+  for(size_t k = 0; k < order.size() && order[k].first < 0; ++k) {
+    vector< pair<int, int> > &row = rows[order[k].second];
+    int b = max(0, firstfree - row.front().first);
+    for(;; ++b) {
+      size_t j;
+      for(j = 0; j < row.size(); ++j) {
+        int cell = b + row[j].first;
+        if(cell < (int) check.size() && check[cell] != -1) break;
+      }
+      if(j == row.size()) break;
+    }
+    base[order[k].second] = b;
+    if(b + first_leaftype > (int) check.size()) {
+      check.resize(b + first_leaftype, -1);
+      value.resize(b + first_leaftype, T_BOTTOM);
+    }
+    for(size_t j = 0; j < row.size(); ++j) {
+      check[b + row[j].first] = order[k].second;
+      value[b + row[j].first] = row[j].second;
+    }
+    while(firstfree < (int) check.size() && check[firstfree] != -1)
+      ++firstfree;
+  }
+
+  f->dump_int(first_leaftype);
+  for(int a = 0; a < first_leaftype; ++a)
+    f->dump_int(base[a]);
+  f->dump_int(check.size());
+  for(size_t i = 0; i < check.size(); ++i) {
+    f->dump_int(check[i]);
+    f->dump_int(value[i]);
+  }
+
+  LOG(logGrammar, DEBUG, "glb table: " << ncells << " cells in "
+      << check.size() << " slots");
+}
+
 #endif
 
 void undump_hierarchy(dumper *f)
@@ -383,6 +491,23 @@ void undump_hierarchy(dumper *f)
     leaftypeparent[i] = f->undump_int();
 }
 
+#ifndef FLOP
+void undump_glbtable(dumper *f)
+{
+  if(f->undump_int() != first_leaftype)
+    throw tError("glb table does not match type hierarchy");
+
+  glbtable_base = new int[first_leaftype];
+  for(int i = 0; i < first_leaftype; ++i)
+    glbtable_base[i] = f->undump_int();
+
+  int size = f->undump_int();
+  glbtable = new int[2 * size];
+  for(int i = 0; i < 2 * size; ++i)
+    glbtable[i] = f->undump_int();
+}
+#endif
+
 void
 initialize_maxapp()
 {
@@ -457,6 +582,93 @@ undumpSupertypes(dumper *f)
     }
 }
 
+void
+initialize_subtype_index()
+{
+  // leaf types form a forest below the proper types: number it in pre and
+  // post order, so that a leaf type a is a subtype of a leaf type b iff the
+  // interval of a is contained in the interval of b
+  vector< vector<int> > children(nstaticleaftypes);
+  vector<int> roots;
+  for(int i = 0; i < nstaticleaftypes; ++i) {
+    type_t parent = leaftypeparent[i];
+    if(is_leaftype(parent))
+      children[parent - first_leaftype].push_back(i);
+    else
+      roots.push_back(i);
+  }
+
+  leaftype_proper = new type_t[nstaticleaftypes];
+  leaftype_pre = new int[nstaticleaftypes];
+  leaftype_post = new int[nstaticleaftypes];
+  int counter = 0;
+  vector< pair<int, size_t> > stack;
+  for(size_t r = 0; r < roots.size(); ++r) {
+    int root = roots[r];
+    leaftype_proper[root] = leaftypeparent[root];
+    leaftype_pre[root] = counter++;
+    stack.push_back(make_pair(root, 0));
+    while(! stack.empty()) {
+      int node = stack.back().first;
+      size_t next = stack.back().second;
+      if(next < children[node].size()) {
+        ++stack.back().second;
+        int child = children[node][next];
+        leaftype_proper[child] = leaftype_proper[node];
+        leaftype_pre[child] = counter++;
+        stack.push_back(make_pair(child, 0));
+      } else {
+        leaftype_post[node] = counter++;
+        stack.pop_back();
+      }
+    }
+  }
+
+  // proper types: one row of supertype bits per type, computed from the
+  // immediate supertypes
+  if((int) immediateSupertype.size() != first_leaftype
+     || first_leaftype > SUBTYPE_INDEX_MAX_TYPES) {
+    LOG(logGrammar, INFO, "no subtype index for proper types");
+    return;
+  }
+
+  subtype_stride = (first_leaftype + 31) / 32;
+  unsigned int *rows = new unsigned int[first_leaftype * subtype_stride];
+  memset(rows, 0, first_leaftype * subtype_stride * sizeof(unsigned int));
+
+  // 0: not visited, 1: on the stack, 2: row complete
+  vector<char> state(first_leaftype, 0);
+  vector<int> todo;
+  for(type_t t = 0; t < first_leaftype; ++t) {
+    if(state[t] != 0) continue;
+    todo.push_back(t);
+    while(! todo.empty()) {
+      type_t a = todo.back();
+      if(state[a] == 0) {
+        state[a] = 1;
+        for(list<int>::const_iterator it = immediateSupertype[a].begin();
+            it != immediateSupertype[a].end(); ++it)
+          if(state[*it] == 0)
+            todo.push_back(*it);
+        continue;
+      }
+      todo.pop_back();
+      if(state[a] == 2) continue;
+      unsigned int *row = rows + a * subtype_stride;
+      row[a / 32] |= 1U << (a % 32);
+      for(list<int>::const_iterator it = immediateSupertype[a].begin();
+          it != immediateSupertype[a].end(); ++it) {
+        const unsigned int *super = rows + *it * subtype_stride;
+        for(int w = 0; w < subtype_stride; ++w)
+          row[w] |= super[w];
+      }
+      state[a] = 2;
+    }
+  }
+
+  subtype_rows = rows;
+}
+
 const list< type_t > &immediate_supertypes(type_t type) {
   assert(is_proper_type(type)) ;
   return immediateSupertype[type];
@@ -554,6 +766,20 @@ bool subtype(int a, int b)
   if(leaftypeparent[b] != -1)
     return false; // only leaftypes can be subtypes of a leaftype
 #else
+  if(leaftype_proper != 0) {
+    if(is_leaftype(a)) {
+      if(is_leaftype(b))
+        return leaftype_pre[b - first_leaftype] <= leaftype_pre[a - first_leaftype]
+          && leaftype_post[a - first_leaftype] <= leaftype_post[b - first_leaftype];
+      a = leaftype_proper[a - first_leaftype];
+      if(a == b) return true;
+    }
+    else if(is_leaftype(b))
+      return false; // only leaftypes can be subtypes of a leaftype
+    if(subtype_rows != 0)
+      return (subtype_rows[a * subtype_stride + b / 32] >> (b % 32)) & 1;
+  }
+
   if(is_leaftype(a))
     return subtype(leaftypeparent[a - first_leaftype], b);
   if(is_leaftype(b))
@@ -604,6 +830,28 @@ subtype_bidir(type_t a, type_t b, bool &forward, bool &backward)
   }
 #endif
 
+    if(subtype_rows != 0)
+    {
+        // both directions are constant time with the subtype index
+        forward = subtype(a, b);
+        backward = subtype(b, a);
+        return;
+    }
+
+    if(leaftype_proper != 0 && is_leaftype(a) && is_leaftype(b))
+    {
+        // without the rows for the proper types, the pre/post numbering
+        // still answers both directions for two leaftypes; everything else
+        // takes the one pass paths below
+        int pa = leaftype_pre[a - first_leaftype];
+        int pb = leaftype_pre[b - first_leaftype];
+        int qa = leaftype_post[a - first_leaftype];
+        int qb = leaftype_post[b - first_leaftype];
+        forward = pb <= pa && qa <= qb;
+        backward = pa <= pb && qb <= qa;
+        return;
+    }
+
 #define SUBTYPE_OPT
 #ifdef SUBTYPE_OPT
     // Handle the slightly complicated case of leaftypes. In PET,
@@ -715,6 +963,12 @@ int glb(int s1, int s2)
   }
 #endif
 
+  // proper types: one lookup in the precomputed table, if we have one
+  if(glbtable != 0 && s2 < first_leaftype) {
+    const int *cell = glbtable + 2 * (glbtable_base[s1] + s2);
+    return (cell[0] == s1) ? cell[1] : T_BOTTOM;
+  }
+
   // result is a _reference_ to the cache entry -> automatic writeback
   int &result = glbcache[ (typecachekey_t) s1*nstatictypes + s2 ];
   if(result) return result;
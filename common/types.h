@@ -155,6 +155,22 @@ void dump_hierarchy(class dumper *f);
  *  leaftypeparents).
  */
 void undump_hierarchy(class dumper *f);
+
+/** Build the index that makes subtype() and subtype_bidir() constant time
+ *  operations. Leaf types get interval labels over the leaf type forest,
+ *  proper types a bit matrix of their supertypes, which is only built if the
+ *  immediate supertypes were loaded.
+ */
+void initialize_subtype_index();
+
+/** Dump a complete table of the glbs of all proper types to \a f, in a
+ *  compressed format that allows constant time lookup.
+ */
+void dump_glbtable(class dumper *f);
+/** Load the glb table written by dump_glbtable(). After that, the glb of two
+ *  proper types is a table lookup and does no longer use the glb cache.
+ */
+void undump_glbtable(class dumper *f);
 /** Load the type-to-featureset mappings and the feature sets for fixed arity
  *  encoding, as well as the table of appropriate types for all attributes.
  */
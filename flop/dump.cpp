@@ -244,6 +244,10 @@ dump_grammar(dumper *f, const char *desc)
   toc.add_section(SEC_INFLR);
   toc.add_section(SEC_IRREGS);
   toc.add_section(SEC_CONSTRAINTS);
+  if(have_rule_filter())
+    toc.add_section(SEC_RULEFILTER);
+  if(get_opt_bool("opt_glb_table"))
+    toc.add_section(SEC_GLBTABLE);
   toc.close();
 
   toc.start_section(SEC_PROPERTIES);
@@ -285,6 +289,18 @@ dump_grammar(dumper *f, const char *desc)
     dag_dump(f, types[cheap2flop[i]]->thedag);
   logkb(", types", f);
 
+  if(have_rule_filter()) {
+    toc.start_section(SEC_RULEFILTER);
+    dump_rule_filter(f);
+    logkb(", rule filter", f);
+  }
+
+  if(get_opt_bool("opt_glb_table")) {
+    toc.start_section(SEC_GLBTABLE);
+    dump_glbtable(f);
+    logkb(", glb table", f);
+  }
+
   toc.dump();
 
 }
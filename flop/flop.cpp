@@ -289,6 +289,9 @@ void process_types()
     log_types("before dumping");
 
   compute_feat_sets(get_opt_bool("opt_minimal"));
+
+  if(get_opt_bool("opt_rule_filter"))
+    compute_rule_filter();
 }
 
 void
@@ -567,6 +570,12 @@ void init() {
     false);
   managed_opt("opt_unfill", "Remove dag nodes whose information is subsumed by the type feature structure of one of its enclosing nodes", false);
   managed_opt("opt_propagate_status", "", false);
+  managed_opt("opt_rule_filter",
+    "precompute the rule and subsumption filters and dump them with the "
+    "grammar", true);
+  managed_opt("opt_glb_table",
+    "dump a complete table of the glbs of all proper types, so that cheap "
+    "does not need the glb cache for them", false);
 
 }
 
@@ -622,6 +622,23 @@ list_int *fully_expand(struct dag_node *dag, bool full);
  */
 void dump_grammar(dumper *f, const char *desc);
 
+/** @name rule-filter.cc */
+/*@{*/
+/** Precompute the unification and subsumption rule filters for all types
+ *  with a rule status, so that cheap does not have to compute them at
+ *  startup.
+ * \return \c false if the filter could not be computed, e.g., because the
+ *  settings do not define the rule status values.
+ */
+bool compute_rule_filter();
+/** \c true if compute_rule_filter() produced a filter to dump */
+bool have_rule_filter();
+/** Dump the precomputed rule filter (section \c SEC_RULEFILTER), together
+ *  with the deleted daughters its subsumption part was computed with.
+ */
+void dump_rule_filter(dumper *f);
+/*@}*/
+
 /** @name dag-tdl.cc */
 /*@{*/
 /** Build the compact symbol tables that will be dumped later on and are used
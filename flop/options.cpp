@@ -45,6 +45,10 @@ void usage(std::ostream &out)
       << std::endl
       << "  `-cmi=level' --- create morph info, level = 0..2, default 0"
       << std::endl
+      << "  `-no-rule-filter' --- don't precompute the rule filter"
+      << std::endl
+      << "  `-glb-table' --- dump a complete glb table for proper types"
+      << std::endl
   //    << "  `-verbose[=n]' --- set verbosity level to n" << std::endl
   //    << "  `-errors-to=n' --- print errors to fd n" << std::endl
     ;
@@ -61,6 +65,8 @@ void usage(std::ostream &out)
 #define OPTION_PROPAGATE_STATUS 10
 #define OPTION_GLBDEBUG 11
 #define OPTION_CMI 12
+#define OPTION_NO_RULE_FILTER 13
+#define OPTION_GLB_TABLE 14
 
 
 char *parse_options(int argc, char* argv[])
@@ -76,6 +82,8 @@ char *parse_options(int argc, char* argv[])
     {"no-semantics", no_argument, 0, OPTION_NO_SEM},
     {"propagate-status", no_argument, 0, OPTION_PROPAGATE_STATUS},
     {"cmi", required_argument, 0, OPTION_CMI},
+    {"no-rule-filter", no_argument, 0, OPTION_NO_RULE_FILTER},
+    {"glb-table", no_argument, 0, OPTION_GLB_TABLE},
     //{"verbose", optional_argument, 0, OPTION_VERBOSE},
     //{"errors-to", required_argument, 0, OPTION_ERRORS_TO},
     {0, 0, 0, 0}
@@ -122,6 +130,12 @@ char *parse_options(int argc, char* argv[])
       if(optarg != NULL)
         set_opt_from_string("opt_cmi", optarg);
       break;
+    case OPTION_NO_RULE_FILTER:
+      set_opt("opt_rule_filter", false);
+      break;
+    case OPTION_GLB_TABLE:
+      set_opt("opt_glb_table", true);
+      break;
     /*
     case OPTION_VERBOSE:
       if(optarg != NULL)
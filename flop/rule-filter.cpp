@@ -0,0 +1,188 @@
+/* PET
+ * Platform for Experimentation with efficient HPSG processing Techniques
+ * (C) 1999 - 2002 Ulrich Callmeier uc@coli.uni-sb.de
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Precompute the rule and subsumption filters for cheap. */
+
+#include "flop.h"
+#include "dag.h"
+#include "dumper.h"
+#include "settings.h"
+#include "logging.h"
+
+#include <vector>
+
+using std::vector;
+
+/** The (flop) type codes of all rules, in dump order */
+static vector<int> filter_rules;
+/** For every mother/daughter pair (mother * nrules + daughter), the bit
+ *  vector of argument positions (bit 0 is the first argument) the daughter
+ *  may be unified into.
+ */
+static vector<char> filter_unif;
+/** For every mother/daughter pair, \c 1 if the restricted daughter may
+ *  subsume the restricted mother, \c 0 otherwise.
+ */
+static vector<char> filter_subs;
+/** The deleted daughters \c filter_subs was computed with. cheap reads them
+ *  from its own settings, so they are dumped to detect a mismatch.
+ */
+static vector<int> filter_deleted;
+
+/** Is the type with flop code \a t a syntactic or lexical rule? */
+static bool
+filter_rule_status(int t)
+{
+  return flop_settings->statusmember("rule-status-values", typestatus[t])
+    || flop_settings->statusmember("lexrule-status-values", typestatus[t]);
+}
+
+/** Check whether \a a may subsume \a b, ignoring all arcs whose attribute is
+ *  in \a del.
+ *
+ * This is a necessary condition only: coreferences are not checked, and arcs
+ * of \a a that are missing in \a b (which may be due to unfilling) are
+ * accepted. A \c false result is therefore reliable, which is all the filter
+ * needs.
+ */
+static bool
+dag_may_subsume_rec(dag_node *a, dag_node *b, list_int *del, int generation)
+{
+  a = dag_deref(a);
+  b = dag_deref(b);
+
+  // already visited on some other path
+  if(dag_get_copy(a, generation) != 0)
+    return true;
+
+  if(!subtype(b->type, a->type))
+    return false;
+
+  dag_set_copy(a, b, generation);
+
+  for(dag_arc *arc = a->arcs; arc != 0; arc = arc->next)
+    {
+      if(contains(del, arc->attr))
+        continue;
+
+      dag_node *bval = dag_get_attr_value(b, arc->attr);
+      if(bval != FAIL
+         && !dag_may_subsume_rec(arc->val, bval, del, generation))
+        return false;
+    }
+
+  return true;
+}
+
+static bool
+dag_may_subsume(dag_node *a, dag_node *b, list_int *del)
+{
+  bool res = dag_may_subsume_rec(a, b, del, copy_generation);
+  dag_invalidate_copy();
+  return res;
+}
+
+bool
+compute_rule_filter()
+{
+  filter_rules.clear();
+  filter_unif.clear();
+  filter_subs.clear();
+  filter_deleted.clear();
+
+  if(flop_settings->lookup("rule-status-values") == 0
+     && flop_settings->lookup("lexrule-status-values") == 0)
+    {
+      LOG(logGrammar, INFO,
+          "no rule status values, not precomputing the rule filter");
+      return false;
+    }
+
+  list_int *del = 0;
+  setting *set = flop_settings->lookup("deleted-daughters");
+  if(set)
+    {
+      for(int i = 0; i < set->n; ++i)
+        {
+          int a = lookup_attr(set->values[i]);
+          if(a != -1)
+            {
+              del = cons(a, del);
+              filter_deleted.push_back(a);
+            }
+        }
+    }
+
+  for(int i = 0; i < types.number(); ++i)
+    if(filter_rule_status(i) && dag_nth_arg(types[i]->thedag, 1) != FAIL)
+      filter_rules.push_back(i);
+
+  int nrules = filter_rules.size();
+  filter_unif.resize(nrules * nrules, 0);
+  filter_subs.resize(nrules * nrules, 0);
+
+  for(int m = 0; m < nrules; ++m)
+    {
+      dag_node *mother = types[filter_rules[m]]->thedag;
+      for(int d = 0; d < nrules; ++d)
+        {
+          dag_node *daughter = types[filter_rules[d]]->thedag;
+          char mask = 0;
+          dag_node *arg;
+          for(int n = 1; n <= 8 && (arg = dag_nth_arg(mother, n)) != FAIL; ++n)
+            {
+              if(dags_compatible(arg, daughter))
+                mask |= (char) (1 << (n - 1));
+            }
+          filter_unif[m * nrules + d] = mask;
+          filter_subs[m * nrules + d] =
+            dag_may_subsume(daughter, mother, del) ? 1 : 0;
+        }
+    }
+
+  free_list(del);
+
+  LOG(logGrammar, INFO, "precomputed rule filter for " << nrules << " rules");
+  return true;
+}
+
+bool
+have_rule_filter()
+{
+  return !filter_rules.empty();
+}
+
+void
+dump_rule_filter(dumper *f)
+{
+  int nrules = filter_rules.size();
+  f->dump_int(nrules);
+  for(int i = 0; i < nrules; ++i)
+    f->dump_int(flop2cheap[filter_rules[i]]);
+
+  f->dump_int(filter_deleted.size());
+  for(size_t i = 0; i < filter_deleted.size(); ++i)
+    f->dump_int(filter_deleted[i]);
+
+  for(int i = 0; i < nrules * nrules; ++i)
+    {
+      f->dump_char(filter_unif[i]);
+      f->dump_char(filter_subs[i]);
+    }
+}